@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+"""Photon bundling check of exampleB1.
+
+Runs the same muon scenario without bundling (exampleB1 -b 1) and with
+a bundle factor N, and compares the end of run summaries of the two:
+- the means must agree within 3 standard errors
+- the rms must match the expected one within --tolerance
+- the speed-up in events/s is reported
+
+By default the photons reaching the SiPMs are compared. Each tracked
+photon then stands for N photons, so the bundled variance is expected
+to be var(1) + (N - 1) mean(1):
+
+  check_bundling.py --exe ./exampleB1 --bundle 10 --events 500
+
+With --digitize the fired SiPM cells are compared, without dark counts.
+The digitizer detects each bundle once with N times the PDE, which gives
+the statistics of unbundled running while N x PDE <= 1, so the bundled
+rms is expected to be the unbundled one. For a larger N the rms is only
+reported (--max-pde is the largest PDE of the digitizer):
+
+  check_bundling.py --exe ./exampleB1 --digitize --bundle 2
+
+Extra UI commands for both runs are passed with --command (repeatable).
+For example, the parametrised strip light needs a calibrated map:
+
+  check_bundling.py --map light_response.bin \\
+      --command "/muon/stacking/stripLightThreads 4"
+
+The exit code is 0 when all checks pass.
+"""
+
+import argparse
+import math
+import os
+import re
+import subprocess
+import sys
+
+
+def run_one(exe, bundle, args):
+    """Runs the scenario with the bundle factor and returns its summary."""
+    name = "bundle_%d" % bundle
+    macro = os.path.join(args.output, name + ".mac")
+    with open(macro, "w") as wrapper:
+        wrapper.write("/control/verbose 0\n")
+        wrapper.write("/run/numberOfThreads %d\n" % args.threads)
+        if args.map:
+            wrapper.write("/muon/detector/lightResponseMap %s\n"
+                          % os.path.abspath(args.map))
+        wrapper.write("/run/initialize\n")
+        if args.digitize:
+            wrapper.write("/muon/sipm/digitize true\n")
+            wrapper.write("/muon/sipm/darkRate 0 kHz\n")
+        for command in args.command:
+            wrapper.write(command + "\n")
+        wrapper.write("/muon/gun/mode fixed\n")
+        wrapper.write("/random/setSeeds %d 67890\n" % (12345 + bundle))
+        wrapper.write("/run/printProgress 0\n")
+        wrapper.write("/run/beamOn %d\n" % args.events)
+
+    process = subprocess.run([exe, macro, "-b", str(bundle), "-p", "full"],
+                             stdout=subprocess.PIPE,
+                             stderr=subprocess.STDOUT,
+                             universal_newlines=True)
+    with open(os.path.join(args.output, name + ".log"), "w") as log_file:
+        log_file.write(process.stdout)
+
+    log = process.stdout
+    position = log.rfind("End of Global Run")
+    quantity = ("fired cells per event" if args.digitize
+                else "photoelectrons per event")
+    match = re.search(r"The run consists of (\d+).*?"
+                      r"\((\S+) events/s\).*?"
+                      + quantity + r": (\S+) \(rms (\S+)\)",
+                      log[position:], re.S) if position >= 0 else None
+    if process.returncode != 0 or not match:
+        sys.exit("exampleB1 -b %d failed, see %s"
+                 % (bundle, os.path.join(args.output, name + ".log")))
+    return (int(match.group(1)), float(match.group(2)),
+            float(match.group(3)), float(match.group(4)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--exe", default="./exampleB1",
+                        help="exampleB1 executable")
+    parser.add_argument("--bundle", type=int, default=10,
+                        help="bundle factor compared with 1")
+    parser.add_argument("--events", type=int, default=500,
+                        help="events of each run")
+    parser.add_argument("--threads", type=int, default=4,
+                        help="number of threads")
+    parser.add_argument("--tolerance", type=float, default=0.15,
+                        help="relative tolerance on the bundled rms")
+    parser.add_argument("--digitize", action="store_true",
+                        help="compare the fired SiPM cells")
+    parser.add_argument("--max-pde", type=float, default=0.40,
+                        help="largest PDE of the digitizer bands")
+    parser.add_argument("--command", action="append", default=[],
+                        help="UI command applied after /run/initialize")
+    parser.add_argument("--map", default="",
+                        help="light response map file of the detector")
+    parser.add_argument("--output", default="bundling_check",
+                        help="directory of the macros and logs")
+    args = parser.parse_args()
+
+    exe = os.path.abspath(args.exe)
+    args.output = os.path.abspath(args.output)
+    if not os.path.isdir(args.output):
+        os.makedirs(args.output)
+
+    n1, rate1, mean1, rms1 = run_one(exe, 1, args)
+    nb, rateb, meanb, rmsb = run_one(exe, args.bundle, args)
+
+    error = math.sqrt(rms1 ** 2 / n1 + rmsb ** 2 / nb)
+    mean_ok = abs(meanb - mean1) <= 3. * error
+    if args.digitize:
+        expected_rms = rms1 if args.bundle * args.max_pde <= 1. else None
+    else:
+        expected_rms = math.sqrt(rms1 ** 2 + (args.bundle - 1) * mean1)
+    rms_ok = (expected_rms is None
+              or abs(rmsb - expected_rms) <= args.tolerance * expected_rms)
+
+    unit = "cells" if args.digitize else "p.e."
+    print("-b 1:  %d events, %.2f events/s, %.2f %s per event (rms %.2f)"
+          % (n1, rate1, mean1, unit, rms1))
+    print("-b %d: %d events, %.2f events/s, %.2f %s per event (rms %.2f)"
+          % (args.bundle, nb, rateb, meanb, unit, rmsb))
+    print("speed-up: %.2f" % (rateb / rate1))
+    print("mean: difference %.2f, 3 standard errors %.2f: %s"
+          % (meanb - mean1, 3. * error, "ok" if mean_ok else "FAILED"))
+    if expected_rms is None:
+        print("rms: not checked, %d x PDE %.2f > 1"
+              % (args.bundle, args.max_pde))
+    else:
+        print("rms: expected %.2f +- %.0f%%: %s"
+              % (expected_rms, 100. * args.tolerance,
+                 "ok" if rms_ok else "FAILED"))
+    return 0 if mean_ok and rms_ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""Optical boundary step benchmark of exampleB1.
+
+Runs optical_bench.mac (vertical muons, full optical tracking, fixed
+seeds, stepping profile enabled) twice and compares the sampled time of
+the optical photon steps that end on a volume boundary:
+- before: every strip built with its own volumes and border surfaces
+  (/muon/detector/stripTemplates false)
+- after: the shared strip templates (the default)
+
+  optical_boundary.py --exe ./exampleB1 --threads 4
+
+With --exe-before the before run uses another build instead (one that
+prints the boundary steps in its stepping profile), with the same macro
+and its default geometry.
+
+The exit code is 0 when both runs report boundary steps.
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+BENCH_DIR = os.path.dirname(os.path.abspath(__file__))
+MACRO = os.path.join(os.path.dirname(BENCH_DIR), "optical_bench.mac")
+
+
+def run_one(exe, name, commands, args):
+    """Runs optical_bench.mac and returns the boundary steps and ns/step."""
+    macro = os.path.join(args.output, name + ".mac")
+    with open(macro, "w") as wrapper:
+        wrapper.write("/control/verbose 0\n")
+        wrapper.write("/run/numberOfThreads %d\n" % args.threads)
+        for command in commands:
+            wrapper.write(command + "\n")
+        wrapper.write("/control/execute %s\n" % MACRO)
+
+    process = subprocess.run([exe, macro, "-p", "full"],
+                             stdout=subprocess.PIPE,
+                             stderr=subprocess.STDOUT,
+                             universal_newlines=True)
+    log_name = os.path.join(args.output, name + ".log")
+    with open(log_name, "w") as log_file:
+        log_file.write(process.stdout)
+
+    log = process.stdout
+    position = log.rfind("Stepping hotspots")
+    match = re.search(r"Optical boundary steps: (\d+), (\S+) s, "
+                      r"(\S+) ns/step", log[position:]) \
+        if position >= 0 else None
+    if process.returncode != 0 or not match:
+        sys.exit("%s run failed, see %s" % (name, log_name))
+    return int(match.group(1)), float(match.group(3))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--exe", default="./exampleB1",
+                        help="exampleB1 executable")
+    parser.add_argument("--exe-before", default="",
+                        help="executable of the before run, default --exe")
+    parser.add_argument("--threads", type=int, default=4,
+                        help="number of threads")
+    parser.add_argument("--output", default="optical_boundary",
+                        help="directory of the macros and logs")
+    args = parser.parse_args()
+
+    exe = os.path.abspath(args.exe)
+    args.output = os.path.abspath(args.output)
+    if not os.path.isdir(args.output):
+        os.makedirs(args.output)
+
+    if args.exe_before:
+        before = run_one(os.path.abspath(args.exe_before), "before", [], args)
+    else:
+        before = run_one(exe, "before",
+                         ["/muon/detector/stripTemplates false"], args)
+    after = run_one(exe, "after", [], args)
+
+    print("before: %d boundary steps, %.1f ns/step" % before)
+    print("after:  %d boundary steps, %.1f ns/step" % after)
+    print("speed-up per boundary step: %.2f" % (before[1] / after[1]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""Benchmark suite of exampleB1.
+
+Runs every scenario macro of this directory in both physics modes
+(exampleB1 -p full|edep) for each number of threads, with the fixed seeds
+of the macros, and writes the events/s, optical tracks/s, startup time
+and peak RSS of every run to <output>/results.csv and results.json.
+
+  run_benchmarks.py --exe ./exampleB1 --threads 1,2,4,8 --output bench_results
+
+The log of every run is kept in the output directory. Compare the result
+files of two releases run on the same machine.
+"""
+
+import argparse
+import csv
+import datetime
+import json
+import os
+import platform
+import re
+import subprocess
+import sys
+
+BENCH_DIR = os.path.dirname(os.path.abspath(__file__))
+SCENARIOS = ["vertical_muon", "cosmic", "partial_module"]
+MODES = ["full", "edep"]
+
+FIELDS = ["scenario", "mode", "threads", "events", "run_wall_s",
+          "events_per_s", "optical_tracks", "optical_tracks_per_s",
+          "startup_s", "peak_rss_mb", "exit_code"]
+
+
+def parse_run_summary(log):
+    """Reads the end of run summary of the master (or sequential) run."""
+    position = log.rfind("End of Global Run")
+    if position < 0:
+        return {}
+    summary = log[position:]
+    result = {}
+    match = re.search(r"The run consists of (\d+)", summary)
+    if match:
+        result["events"] = int(match.group(1))
+    match = re.search(r"Wall time: (\S+) s \((\S+) events/s\)", summary)
+    if match:
+        result["run_wall_s"] = float(match.group(1))
+        result["events_per_s"] = float(match.group(2))
+    match = re.search(r"Optical tracks: (\S+) \((\S+) tracks/s\)", summary)
+    if match:
+        result["optical_tracks"] = float(match.group(1))
+        result["optical_tracks_per_s"] = float(match.group(2))
+    return result
+
+
+def run_one(exe, scenario, mode, threads, output):
+    """Runs one configuration and returns its result row."""
+    name = "%s_%s_t%d" % (scenario, mode, threads)
+    startup_file = os.path.join(output, name + "_startup.json")
+    macro = os.path.join(output, name + ".mac")
+    with open(macro, "w") as wrapper:
+        wrapper.write("/control/verbose 0\n")
+        wrapper.write("/run/numberOfThreads %d\n" % threads)
+        wrapper.write("/muon/profile/startupFile %s\n" % startup_file)
+        wrapper.write("/control/execute %s\n"
+                      % os.path.join(BENCH_DIR, scenario + ".mac"))
+
+    process = subprocess.Popen([exe, macro, "-p", mode],
+                               stdout=subprocess.PIPE,
+                               stderr=subprocess.STDOUT,
+                               universal_newlines=True)
+    log = process.stdout.read()
+    # wait4 gives the resource usage of this child only
+    _, status, usage = os.wait4(process.pid, 0)
+    process.returncode = (os.WEXITSTATUS(status) if os.WIFEXITED(status)
+                          else -os.WTERMSIG(status))
+    with open(os.path.join(output, name + ".log"), "w") as log_file:
+        log_file.write(log)
+
+    row = dict.fromkeys(FIELDS)
+    row.update(scenario=scenario, mode=mode, threads=threads,
+               exit_code=process.returncode)
+    row.update(parse_run_summary(log))
+    # kilobytes on Linux, bytes on macOS
+    scale = 1024.0 * 1024.0 if sys.platform == "darwin" else 1024.0
+    row["peak_rss_mb"] = usage.ru_maxrss / scale
+    if os.path.exists(startup_file):
+        with open(startup_file) as profile:
+            phases = json.load(profile)["phases"]
+        row["startup_s"] = sum(phase["wall_s"] for phase in phases)
+    return row
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--exe", default="./exampleB1",
+                        help="exampleB1 executable")
+    parser.add_argument("--threads", default="1,2,4,8",
+                        help="comma separated numbers of threads")
+    parser.add_argument("--scenarios", default=",".join(SCENARIOS),
+                        help="comma separated scenario macros of bench/")
+    parser.add_argument("--modes", default=",".join(MODES),
+                        help="comma separated physics modes")
+    parser.add_argument("--output", default="bench_results",
+                        help="directory of the results and logs")
+    args = parser.parse_args()
+
+    exe = os.path.abspath(args.exe)
+    output = os.path.abspath(args.output)
+    if not os.path.isdir(output):
+        os.makedirs(output)
+
+    rows = []
+    for scenario in args.scenarios.split(","):
+        for mode in args.modes.split(","):
+            for threads in [int(n) for n in args.threads.split(",")]:
+                row = run_one(exe, scenario, mode, threads, output)
+                rows.append(row)
+                print("%-16s %-5s %3d threads: %s events/s, %s MB"
+                      % (scenario, mode, threads, row["events_per_s"],
+                         row["peak_rss_mb"]))
+                sys.stdout.flush()
+
+    with open(os.path.join(output, "results.csv"), "w") as csv_file:
+        writer = csv.DictWriter(csv_file, fieldnames=FIELDS)
+        writer.writeheader()
+        writer.writerows(rows)
+
+    with open(os.path.join(output, "results.json"), "w") as json_file:
+        json.dump({"date": datetime.datetime.now().isoformat(),
+                   "host": platform.node(),
+                   "platform": platform.platform(),
+                   "executable": exe,
+                   "runs": rows}, json_file, indent=2)
+
+    return 0 if all(row["exit_code"] == 0 for row in rows) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
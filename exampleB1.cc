@@ -1,5 +1,8 @@
 #include "DetectorConstruction.hh"
 #include "ActionInitialization.hh"
+#include "CalibrationScan.hh"
+#include "PhysicsList.hh"
+#include "StartupProfiler.hh"
 
 #ifdef G4MULTITHREADED
 #include "G4MTRunManager.hh"
@@ -8,23 +11,60 @@
 #endif
 
 #include "G4UImanager.hh"
-#include "FTFP_BERT.hh"
-#include "G4OpticalPhysics.hh"
-#include "G4EmStandardPhysics_option4.hh"
 
 #include "G4VisExecutive.hh"
 #include "G4UIExecutive.hh"
 
 #include "Randomize.hh"
 
+#include <algorithm>
+#include <cstdlib>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+  void PrintUsage() {
+    G4cerr << " Usage: " << G4endl;
+    G4cerr << " exampleB1 [macro] [-b photonBundleFactor] [-p full|edep]"
+           << G4endl;
+  }
+}
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 int main(int argc,char** argv)
 {
-  // Detect interactive mode (if no arguments) and define UI session
+  // Startup phases are timed from here
+  //
+  auto startupProfiler = StartupProfiler::Instance();
+
+  // Evaluate arguments
+  //
+  G4String macro;
+  G4int photonBundleFactor = 1;
+  PhysicsList::Mode physicsMode = PhysicsList::Mode::kFull;
+  for ( G4int i = 1; i < argc; ++i ) {
+    G4String argument = argv[i];
+    if ( argument == "-b" && i + 1 < argc ) {
+      photonBundleFactor = std::max(1, std::atoi(argv[++i]));
+    }
+    else if ( argument == "-p" && i + 1 < argc
+              && PhysicsList::GetModeFromName(argv[i + 1], physicsMode) ) {
+      ++i;
+    }
+    else if ( argument[0] != '-' ) {
+      macro = argument;
+    }
+    else {
+      PrintUsage();
+      return 1;
+    }
+  }
+
+  // Detect interactive mode (if no macro) and define UI session
   //
   G4UIExecutive* ui = 0;
-  if ( argc == 1 ) {
+  if ( macro.empty() ) {
     ui = new G4UIExecutive(argc, argv);
   }
 
@@ -38,34 +78,32 @@ int main(int argc,char** argv)
 #else
   G4RunManager* runManager = new G4RunManager;
 #endif
+  startupProfiler->EndPhase("run manager");
 
   // Set mandatory initialization classes
   //
   // Detector construction
-  runManager->SetUserInitialization(new DetectorConstruction());
-
-  // Physics list
-  G4VModularPhysicsList* physicsList = new FTFP_BERT;
-  physicsList->ReplacePhysics(new G4EmStandardPhysics_option4());
-  G4OpticalPhysics* opticalPhysics = new G4OpticalPhysics();
-
-  opticalPhysics->SetWLSTimeProfile("delta");
-  opticalPhysics->SetScintillationYieldFactor(1.0);
-  opticalPhysics->SetScintillationExcitationRatio(0.0);
-  opticalPhysics->SetMaxNumPhotonsPerStep(100);
-  opticalPhysics->SetMaxBetaChangePerStep(10.0);
-  opticalPhysics->SetTrackSecondariesFirst(kCerenkov, true);
-  opticalPhysics->SetTrackSecondariesFirst(kScintillation, true);
-  physicsList->RegisterPhysics(opticalPhysics);
-  runManager->SetUserInitialization(physicsList);
+  auto detectorConstruction = new DetectorConstruction();
+  detectorConstruction->SetPhotonBundleFactor(photonBundleFactor);
+  runManager->SetUserInitialization(detectorConstruction);
+
+  // Calibration scan commands (/muon/calibration/)
+  CalibrationScan::Instance();
+
+  // Physics list: full optical or energy deposit only (-p)
+  runManager->SetUserInitialization(
+    new PhysicsList(physicsMode, photonBundleFactor));
     
   // User action initialization
-  runManager->SetUserInitialization(new ActionInitialization());
+  G4bool edepMode = ( physicsMode == PhysicsList::Mode::kEdep );
+  runManager->SetUserInitialization(
+    new ActionInitialization(photonBundleFactor, edepMode));
   
   // Initialize visualization
   //
   G4VisManager* visManager = new G4VisExecutive;
   visManager->Initialize();
+  startupProfiler->EndPhase("user classes and vis");
 
   // Get the pointer to the User Interface manager
   G4UImanager* UImanager = G4UImanager::GetUIpointer();
@@ -75,8 +113,7 @@ int main(int argc,char** argv)
   if ( ! ui ) { 
     // batch mode
     G4String command = "/control/execute ";
-    G4String fileName = argv[1];
-    UImanager->ApplyCommand(command+fileName);
+    UImanager->ApplyCommand(command+macro);
   }
   else { 
     // interactive mode
@@ -31,17 +31,29 @@
 #define ActionInitialization_h 1
 
 #include "G4VUserActionInitialization.hh"
+#include "globals.hh"
 
 /// Action initialization class.
+///
+/// The photon bundle factor is passed to the tracking action, which
+/// weights the scintillation photons, and to the stacking action for the
+/// deferred strip photons that are never tracked. In the energy-deposit physics mode
+/// the stepping action converts the scintillator deposits into
+/// photoelectrons.
 
 class ActionInitialization : public G4VUserActionInitialization
 {
   public:
-    ActionInitialization();
+    ActionInitialization(G4int photonBundleFactor = 1,
+                         G4bool edepMode = false);
     virtual ~ActionInitialization();
 
     virtual void BuildForMaster() const;
     virtual void Build() const;
+
+  private:
+    G4int fPhotonBundleFactor;
+    G4bool fEdepMode;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,95 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file AsyncEventWriter.hh
+/// \brief Definition of the AsyncEventWriter class
+
+#ifndef AsyncEventWriter_h
+#define AsyncEventWriter_h 1
+
+#include "EventFormat.hh"
+#include "SpscQueue.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Hits of one event, as handed over to the writer thread
+struct EventRecord
+{
+  std::int32_t eventId = 0;
+  std::vector<std::uint32_t> channel;
+  std::vector<std::uint32_t> photoelectrons;
+  std::vector<float> time;
+};
+
+/// Event file writer running on its own thread.
+///
+/// The simulation thread moves finished EventRecords onto a bounded
+/// single-producer single-consumer queue; a dedicated thread drains it,
+/// builds and compresses the blocks and writes them with
+/// EventFormat::Writer. The simulation thread only waits when the queue
+/// is full, and that time is reported as stall time.
+
+class AsyncEventWriter
+{
+  public:
+    AsyncEventWriter();
+    ~AsyncEventWriter();
+
+    bool Open(const std::string& fileName, std::size_t queueDepth,
+              int compressionLevel);
+    // drains the queue, writes the index and joins the writer thread
+    void Close();
+    bool IsOpen() const { return fThread.joinable(); }
+
+    void Push(EventRecord&& record);
+
+    std::size_t GetQueueCapacity() const;
+    std::size_t GetMaxQueueDepth() const { return fMaxDepth; }
+    std::uint64_t GetNStalls() const { return fNStalls; }
+    double GetStallTime() const { return fStallTime; }  // seconds
+    const EventFormat::Writer& GetWriter() const { return fWriter; }
+
+  private:
+    void Drain();
+    void Write(const EventRecord& record);
+
+    EventFormat::Writer fWriter;
+    SpscQueue<EventRecord>* fQueue;
+    std::thread fThread;
+    std::atomic<bool> fDone;
+
+    std::size_t fMaxDepth;
+    std::uint64_t fNStalls;
+    double fStallTime;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,81 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file BarrelAcceptance.hh
+/// \brief Definition of the BarrelAcceptance class
+
+#ifndef BarrelAcceptance_h
+#define BarrelAcceptance_h 1
+
+#include "G4AffineTransform.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4VSolid;
+class G4VPhysicalVolume;
+
+/// Straight-line acceptance of the barrel.
+///
+/// A track is accepted when its line crosses one of the Fe trapezoids
+/// (the strips are inside them). The line is first tested against the
+/// cylinder around the z axis that bounds all trapezoids, which rejects
+/// most misses; the survivors are tested against each trapezoid with
+/// G4VSolid::DistanceToIn in its local frame.
+///
+/// The trapezoids are collected from the geometry at the first call,
+/// and again when the world volume has changed.
+
+class BarrelAcceptance
+{
+  public:
+    BarrelAcceptance();
+    ~BarrelAcceptance();
+
+    G4bool Accept(const G4ThreeVector& position,
+                  const G4ThreeVector& direction);
+
+  private:
+    void Initialize(G4VPhysicalVolume* world);
+    G4bool CrossesCylinder(const G4ThreeVector& position,
+                           const G4ThreeVector& direction) const;
+
+    struct Absorber
+    {
+      const G4VSolid* solid;
+      G4AffineTransform worldToLocal;
+    };
+
+    G4VPhysicalVolume* fWorld;
+    std::vector<Absorber> fAbsorbers;
+    G4double fRadius;
+    G4double fHalfLength;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,113 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file CalibrationScan.hh
+/// \brief Definition of the CalibrationScan class
+
+#ifndef CalibrationScan_h
+#define CalibrationScan_h 1
+
+#include "LightResponseMap.hh"
+#include "G4AffineTransform.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4GenericMessenger;
+class G4ParticleDefinition;
+class Run;
+
+/// Calibration scan of the strip optical response.
+///
+/// /muon/calibration/run fires muons perpendicular to one strip on a
+/// grid of (position along the strip, transverse offset) cells with full
+/// optical tracking, eventsPerCell consecutive events per cell, and
+/// writes the detected photons, visible deposit and first arrival times
+/// per SiPM end to a LightResponseMap file. The particle and energy of
+/// the scan (mu- of 1024 MeV by default) are set independently of the
+/// gun mode. In MT mode the event modulo is set to eventsPerCell during
+/// the scan so that each worker processes whole cells, and restored after.
+///
+/// The file is rewritten at the end of every run and cells already
+/// complete are skipped, so a scan can be done in several runs
+/// (/muon/calibration/run maxCells) and resumed after an interruption.
+///
+/// The scan is configured and run on the master; the workers only read
+/// the cell list while the run is active.
+
+class CalibrationScan
+{
+  public:
+    static CalibrationScan* Instance();
+
+    G4bool IsActive() const { return fActive; }
+    G4int GetNCells() const { return fMap.GetNCells(); }
+    G4int GetCell(G4int eventID) const
+      { return fPendingCells[eventID / fEventsPerCell]; }
+    G4int GetChannel(G4int end) const { return fChannels[end]; }
+    void GetPrimary(G4int eventID,
+                    G4ThreeVector& position, G4ThreeVector& direction) const;
+    G4ParticleDefinition* GetParticle() const { return fParticle; }
+    G4double GetEnergy() const { return fEnergy; }
+
+    void EndOfRun(const Run* run);
+
+  private:
+    CalibrationScan();
+    ~CalibrationScan();
+
+    void DefineCommands();
+    void SetStrip(G4String value);
+    void Start(G4int maxCells);
+    G4bool LocateStrip();
+
+    G4GenericMessenger* fMessenger;
+    G4bool fActive;
+
+    G4int fNAlong;
+    G4int fNAcross;
+    G4int fEventsPerCell;
+    G4String fFileName;
+    G4String fParticleName;
+    G4double fEnergy;
+    G4int fHalf;
+    G4int fSector;
+    G4int fLayer;
+    G4int fOrientation;
+    G4int fStrip;
+
+    G4ParticleDefinition* fParticle;
+    LightResponseMap fMap;
+    std::vector<G4int> fPendingCells;
+    G4AffineTransform fStripToWorld;
+    G4double fStripHalfThickness;
+    G4int fChannels[2];
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
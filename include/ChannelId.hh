@@ -0,0 +1,144 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ChannelId.hh
+/// \brief Definition of the SiPM channel identifier
+
+#ifndef ChannelId_h
+#define ChannelId_h 1
+
+#include "G4VTouchable.hh"
+#include "globals.hh"
+
+#include <cstdint>
+
+/// SiPM channel identifier.
+///
+/// A channel is (z-half, sector, layer, orientation, strip, end). It is
+/// packed in 32 bits as
+///
+///   bit  0      end          (0: -y side, 1: +y side of the strip)
+///   bits 1-7    strip        (index within the half-layer)
+///   bit  8      orientation  (0: 200 cm strips, 1: transverse strips)
+///   bits 9-11   layer
+///   bits 12-15  sector
+///   bit  16     half         (0: z < 0, 1: z > 0)
+///
+/// and maps to a dense index in [0, kNumChannels) for flat per-channel
+/// arrays. The copy numbers set at placement in DetectorConstruction
+/// carry these fields, so the decoder needs a fixed number of
+/// GetCopyNumber(depth) calls on the touchable.
+
+namespace ChannelId
+{
+  const G4int kHalves = 2;
+  const G4int kSectors = 12;
+  const G4int kLayers = 6;
+  const G4int kOrientations = 2;
+  const G4int kStrips = 100;  // maximum number of strips in a half-layer
+  const G4int kEnds = 2;
+  const G4int kNumStrips
+    = kHalves * kSectors * kLayers * kOrientations * kStrips;
+  const G4int kNumChannels = kNumStrips * kEnds;
+
+  // depth of the ancestors, counted from a SiPM and from a Strip
+  const G4int kSiPMToStripDepth = 2;
+  const G4int kStripToLayerDepth = 2;
+  const G4int kStripToEnvelopeDepth = 4;
+
+  // copy numbers used at placement
+  inline G4int EnvelopeCopyNo(G4int half, G4int sector)
+  { return half * kSectors + sector; }
+  inline G4int StripCopyNo(G4int orientation, G4int strip)
+  { return orientation * kStrips + strip; }
+
+  inline std::uint32_t Pack(G4int half, G4int sector, G4int layer,
+                            G4int orientation, G4int strip, G4int end)
+  {
+    return std::uint32_t(end)
+         | std::uint32_t(strip) << 1
+         | std::uint32_t(orientation) << 8
+         | std::uint32_t(layer) << 9
+         | std::uint32_t(sector) << 12
+         | std::uint32_t(half) << 16;
+  }
+
+  inline G4int GetEnd(std::uint32_t id)         { return id & 0x1; }
+  inline G4int GetStrip(std::uint32_t id)       { return (id >> 1) & 0x7f; }
+  inline G4int GetOrientation(std::uint32_t id) { return (id >> 8) & 0x1; }
+  inline G4int GetLayer(std::uint32_t id)       { return (id >> 9) & 0x7; }
+  inline G4int GetSector(std::uint32_t id)      { return (id >> 12) & 0xf; }
+  inline G4int GetHalf(std::uint32_t id)        { return (id >> 16) & 0x1; }
+
+  // same channel at the other end of the strip
+  inline std::uint32_t GetOtherEnd(std::uint32_t id) { return id ^ 0x1; }
+
+  inline G4int ToIndex(std::uint32_t id)
+  {
+    G4int index = GetHalf(id) * kSectors + GetSector(id);
+    index = index * kLayers + GetLayer(id);
+    index = index * kOrientations + GetOrientation(id);
+    index = index * kStrips + GetStrip(id);
+    return index * kEnds + GetEnd(id);
+  }
+
+  inline std::uint32_t FromIndex(G4int index)
+  {
+    G4int end = index % kEnds;          index /= kEnds;
+    G4int strip = index % kStrips;      index /= kStrips;
+    G4int orientation = index % kOrientations; index /= kOrientations;
+    G4int layer = index % kLayers;      index /= kLayers;
+    G4int sector = index % kSectors;
+    G4int half = index / kSectors;
+    return Pack(half, sector, layer, orientation, strip, end);
+  }
+
+  // strip index in [0, kNumStrips), both ends of a strip share it
+  inline G4int ToStripIndex(std::uint32_t id) { return ToIndex(id) / kEnds; }
+
+  /// Channel of a strip (end 0), the Strip volume being at the given depth
+  inline std::uint32_t FromStripTouchable(const G4VTouchable* touchable,
+                                          G4int depth = 0)
+  {
+    G4int stripCopy = touchable->GetCopyNumber(depth);
+    G4int layer = touchable->GetCopyNumber(depth + kStripToLayerDepth);
+    G4int envelopeCopy
+      = touchable->GetCopyNumber(depth + kStripToEnvelopeDepth);
+    return Pack(envelopeCopy / kSectors, envelopeCopy % kSectors, layer,
+                stripCopy / kStrips, stripCopy % kStrips, 0);
+  }
+
+  /// Channel of a SiPM, the SiPM volume being at depth 0
+  inline std::uint32_t FromSiPMTouchable(const G4VTouchable* touchable)
+  {
+    return FromStripTouchable(touchable, kSiPMToStripDepth)
+         | std::uint32_t(touchable->GetCopyNumber(0));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
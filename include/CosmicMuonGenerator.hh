@@ -0,0 +1,114 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file CosmicMuonGenerator.hh
+/// \brief Definition of the CosmicMuonGenerator class
+
+#ifndef CosmicMuonGenerator_h
+#define CosmicMuonGenerator_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4GenericMessenger;
+class G4ParticleDefinition;
+
+/// Sea-level cosmic muon generator.
+///
+/// The differential flux in energy and zenith angle is the Gaisser
+/// parametrisation with the low-energy and curved-atmosphere corrections
+/// of Guan et al. (arXiv:1509.06176). At initialisation the flux is
+/// tabulated on a (cos zenith, log energy) grid, weighted with the
+/// acceptance of the generation surface, and turned into a Walker alias
+/// table. Each event then costs one table lookup: the cell is drawn in
+/// O(1) and the energy and angle are uniform inside it (log-uniform in
+/// energy). Nothing is integrated at run time.
+///
+/// The muons start either from a horizontal plane above the barrel
+/// (flux weighted with cos zenith) or from a disk tangent to a sphere
+/// around the barrel, perpendicular to the muon direction. The vertical
+/// axis is +y. The charge is drawn from the mu+/mu- ratio.
+///
+/// Commands are under /muon/gun/cosmic/; changing any of them rebuilds
+/// the tables at the next event.
+
+class CosmicMuonGenerator
+{
+  public:
+    CosmicMuonGenerator();
+    ~CosmicMuonGenerator();
+
+    void Generate(G4ParticleDefinition*& particle, G4double& kineticEnergy,
+                  G4ThreeVector& position, G4ThreeVector& direction);
+
+    // muons per second crossing the generation surface
+    G4double GetRate();
+
+    // differential flux, per (cm2 s sr GeV), of total energy in GeV
+    static G4double Flux(G4double energy, G4double cosTheta);
+
+  private:
+    void DefineCommands();
+    void BuildTables();
+    void SetSurface(G4String surface);
+    void SetMinEnergy(G4double value)  { fMinEnergy = value; fValid = false; }
+    void SetMaxEnergy(G4double value)  { fMaxEnergy = value; fValid = false; }
+    void SetMaxZenith(G4double value)  { fMaxZenith = value; fValid = false; }
+    void SetPlaneHeight(G4double value)   { fPlaneHeight = value; fValid = false; }
+    void SetPlaneHalfSize(G4double value) { fPlaneHalfSize = value; fValid = false; }
+    void SetSphereRadius(G4double value)  { fSphereRadius = value; fValid = false; }
+
+    G4GenericMessenger* fMessenger;
+    G4ParticleDefinition* fMuPlus;
+    G4ParticleDefinition* fMuMinus;
+
+    // parameters
+    G4bool fSphere;
+    G4double fMinEnergy;      // kinetic
+    G4double fMaxEnergy;      // kinetic
+    G4double fMaxZenith;
+    G4double fPlaneHeight;
+    G4double fPlaneHalfSize;
+    G4double fSphereRadius;
+    G4double fChargeRatio;    // mu+ / mu-
+    G4int fNCosBins;
+    G4int fNEnergyBins;
+
+    // tables
+    G4bool fValid;
+    G4double fCosMin;
+    G4double fLogEMin;        // of the total energy
+    G4double fLogEStep;
+    std::vector<G4double> fAliasProbability;
+    std::vector<G4int> fAlias;
+    G4double fRate;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
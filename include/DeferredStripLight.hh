@@ -0,0 +1,102 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file DeferredStripLight.hh
+/// \brief Definition of the DeferredStripLight class
+
+#ifndef DeferredStripLight_h
+#define DeferredStripLight_h 1
+
+#include "LightResponseMap.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <cstdint>
+#include <vector>
+
+class SiPMSD;
+
+/// Parametrised light of the deferred optical photons of one event.
+///
+/// This is not optical tracking. The photons of the strips above
+/// threshold are killed when they are classified and converted to
+/// photoelectrons with a calibrated LightResponseMap, like the fast light
+/// model does for the strip deposits. The stacking action uses it only
+/// with a map read from a calibration scan file.
+///
+/// Process() evaluates the strips as independent tasks on the shared
+/// TaskPool. Each task computes, for both ends of its strip, the
+/// expected photoelectrons and the earliest emission time. The expected
+/// photoelectrons are the photon weight times the calibrated detection
+/// probability at the photon position. No random number is drawn on the
+/// pool, so the result does not depend on the number of threads. The
+/// event thread then samples the counts and the arrival times and adds
+/// them to the SiPM sensitive detector.
+
+class DeferredStripLight
+{
+  public:
+    DeferredStripLight();
+    ~DeferredStripLight();
+
+    G4bool IsEmpty() const { return fStrips.empty(); }
+
+    void AddPhoton(std::uint32_t stripId, G4double halfLength,
+                   const G4ThreeVector& localPosition,
+                   G4double time, G4double weight);
+
+    // photonsPerMeV: scintillation yield of the strips,
+    // nThreads: helper threads of the shared pool
+    void Process(const LightResponseMap* responseMap, SiPMSD* sipmSD,
+                 G4double photonsPerMeV, G4int nThreads);
+    void Clear();
+
+  private:
+    struct Photon {
+      float x;
+      float y;
+      float weight;
+      G4double time;
+    };
+    struct Strip {
+      std::uint32_t stripId;
+      G4double halfLength;
+      std::vector<Photon> photons;
+      G4double meanPe[2];
+      G4double firstTime[2];
+      const LightResponseMap::Record* firstRecord[2];
+    };
+
+    void Evaluate(Strip& strip, const LightResponseMap* responseMap,
+                  G4double photonsPerMeV) const;
+
+    std::vector<Strip> fStrips;
+    std::vector<G4int> fStripSlots;   // index in fStrips per strip, or -1
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
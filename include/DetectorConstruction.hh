@@ -32,6 +32,9 @@
 
 #include "G4VUserDetectorConstruction.hh"
 #include "globals.hh"
+#include "G4RotationMatrix.hh"
+
+#include <map>
 
 class G4VPhysicalVolume;
 class G4LogicalVolume;
@@ -40,8 +43,50 @@ class G4Material;
 class G4Element;
 class G4MaterialPropertiesTable;
 class G4LogicalBorderSurface;
+class G4OpticalSurface;
+class G4Region;
+class G4GenericMessenger;
+class LightResponseMap;
+class StripLightModel;
 
 /// Detector construction class to define materials and geometry.
+///
+/// The /muon/detector/ commands select optional features before
+/// /run/initialize, e.g. the fast light model of the strips.
+///
+/// The Fe absorbers, the Al supports and the strips are the roots of
+/// the regions FeAbsorberRegion, AlSupportRegion and StripRegion, each
+/// with its own production cuts (/muon/detector/absorberCut, supportCut
+/// and stripCut, or /run/setCutForRegion). The region names can also be
+/// given to /process/em/AddEmRegion to use another EM configuration in
+/// the passive material.
+///
+/// /muon/detector/halves, sectors and layers restrict the build to a
+/// part of the barrel, e.g. one sector module for R&D. The modules that
+/// are built keep their positions, strip geometry and channel IDs. The
+/// selection can be changed after initialisation; the geometry is then
+/// rebuilt (/run/reinitializeGeometry) and each thread attaches its
+/// existing SiPM sensitive detector and fast light model to the new
+/// volumes.
+///
+/// With /muon/detector/geometryCache <directory> (GDML builds only) the
+/// constructed barrel is written to <directory>/muon_geometry_<key>.gdml,
+/// the key being a hash of the construction parameters (half, sector and
+/// layer selections, the materials with their optical properties and
+/// Birks constants, the optical surfaces, and a version constant for
+/// the volume layout), and later jobs with the same parameters read
+/// that file instead of building the geometry. Materials, optical
+/// properties and surfaces come from the file, as new material
+/// instances; code that needs the scintillator takes it from the
+/// volumes, not by name. Volume roles, regions and the Birks constant
+/// are restored by volume name. The construction or load time is
+/// printed (/muon/detector/verbose 1, the default); verbose 2 also
+/// prints the built modules, strip templates and border surfaces.
+///
+/// /muon/detector/stripTemplates false builds every strip with its own
+/// volumes and border surfaces, as before the strip templates, to
+/// measure the optical boundary steps against the shared templates
+/// (bench/optical_boundary.py).
 
 class DetectorConstruction : public G4VUserDetectorConstruction
 {
@@ -50,11 +95,51 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     virtual ~DetectorConstruction();
 
     virtual G4VPhysicalVolume* Construct();
+    virtual void ConstructSDandField();
     void ConstructMaterials();
 
+    // optical photon bundle factor, passed to the SiPM sensitive detector
+    void SetPhotonBundleFactor(G4int factor) { fPhotonBundleFactor = factor; }
+
+    // strip response used by the fast light model and the edep physics mode
+    const LightResponseMap* GetLightResponseMap() const
+      { return fLightResponseMap; }
+
   protected:
   private:
     void DefineMaterials();
+    void DefineOpticalSurfaces();
+    void DefineCommands();
+    G4VPhysicalVolume* ConstructBarrel();
+    G4LogicalVolume* GetStripTemplate(G4double strip_sizeY);
+    G4String GetGeometryCacheFile() const;
+    G4VPhysicalVolume* ReadGeometryCache(const G4String& fileName);
+    void WriteGeometryCache(G4VPhysicalVolume* world, const G4String& fileName);
+    G4Region* CreateRegion(const G4String& name, G4double cut);
+    void SetAbsorberCut(G4double cut);
+    void SetSupportCut(G4double cut);
+    void SetStripCut(G4double cut);
+    void SetHalves(G4String value);
+    void SetSectors(G4String value);
+    void SetLayers(G4String value);
+    G4int ParseSelection(const G4String& value, G4int size,
+                         const G4String& what);
+    void CleanGeometry();
+
+    G4bool fCheckOverlaps;
+
+    // bit i set: z-half, sector or layer i is built
+    G4int fHalfMask;
+    G4int fSectorMask;
+    G4int fLayerMask;
+    G4int fPhotonBundleFactor;
+
+    // strip volumes keyed by strip half-length, built once and placed
+    // in every layer that needs a strip of that length
+    std::map<G4double, G4LogicalVolume*> fStripTemplates;
+    G4RotationMatrix* fStripRotation;
+    G4RotationMatrix* fFiberRotation;
+    G4Box* fSolidSiPM;
 
     G4Material* fBC420;
     G4Material* fAir;
@@ -63,6 +148,7 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     G4Material* fPMMA;
     G4Material* fPethylene1;
     G4Material* fFe;
+    G4Material* fAl;
 
     G4Element* fC;
     G4Element* fH;
@@ -70,6 +156,26 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     G4Element* fO;
 
     G4MaterialPropertiesTable* BC420MPT;
+
+    G4OpticalSurface* fSurfaceOptical;
+    G4OpticalSurface* fCladdingOptical;
+
+    G4GenericMessenger* fMessenger;
+    G4Region* fStripRegion;
+    G4Region* fAbsorberRegion;
+    G4Region* fSupportRegion;
+    G4double fAbsorberCut;
+    G4double fSupportCut;
+    G4double fStripCut;
+    G4bool fFastLightModel;
+    G4String fLightResponseFile;
+    LightResponseMap* fLightResponseMap;
+    G4String fGeometryCacheDir;
+    G4bool fShareStripTemplates;
+    G4int fVerboseLevel;
+
+    // created once per thread, kept over geometry rebuilds
+    static G4ThreadLocal StripLightModel* fStripLightModel;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -31,12 +31,24 @@
 #define EventAction_h 1
 
 #include "G4UserEventAction.hh"
+#include "SiPMHit.hh"
 #include "globals.hh"
 
+#include <vector>
+
 class RunAction;
+class SiPMDigitizer;
 
 /// Event action class
 ///
+/// At the end of the event it reads the SiPM hits collection and passes
+/// the number of fired channels and photoelectrons to the run action.
+/// When /muon/sipm/digitize is on, it runs the SiPMDigitizer module and
+/// the event output holds the digis instead of the hits.
+///
+/// It also keeps the energy deposited in each strip during the event,
+/// which the stacking action uses to select the strips whose optical
+/// photons are tracked.
 
 class EventAction : public G4UserEventAction
 {
@@ -47,8 +59,35 @@ class EventAction : public G4UserEventAction
     virtual void BeginOfEventAction(const G4Event* event);
     virtual void EndOfEventAction(const G4Event* event);
 
+    void AddOpticalBoundaryStep() { fOpticalBoundarySteps++; }
+    void AddOpticalTrack() { fOpticalTracks++; }
+    void AddVisibleEdep(G4double edep) { fVisibleEdep += edep; }
+    G4bool IsCalibrating() const { return fCalibrating; }
+    // strip index of the calibration scan, -1 outside the scan
+    G4int GetCalibrationStrip() const { return fCalibrationStrip; }
+
+    void AddStripEdep(G4int strip, G4double edep);
+    G4double GetStripEdep(G4int strip) const { return fStripEdep[strip]; }
+
   private:
+    void RecordStripResponse(const SiPMHitsCollection* hitsCollection);
+    void RecordCalibration(const G4Event* event,
+                           const SiPMHitsCollection* hitsCollection);
+
     RunAction* fRunAction;
+    SiPMDigitizer* fDigitizer;
+    G4int      fSiPMHCID;
+    G4int      fSiPMDCID;
+    G4double   fOpticalBoundarySteps;
+    G4double   fOpticalTracks;
+    G4double   fVisibleEdep;
+    G4bool     fCalibrating;
+    G4int      fCalibrationStrip;
+
+    // per strip, indexed by ChannelId::ToStripIndex
+    std::vector<G4double> fStripEdep;
+    std::vector<G4int> fHitStrips;
+    std::vector<G4int> fDetectingEnds;   // per strip, in the current event
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
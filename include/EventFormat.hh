@@ -0,0 +1,202 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file EventFormat.hh
+/// \brief Definition of the columnar event file format
+
+#ifndef EventFormat_h
+#define EventFormat_h 1
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// Columnar, append-only event file (.mev).
+///
+/// The file starts with a FileHeader and is a sequence of blocks. Each
+/// block is a BlockHeader followed by its columns:
+///
+///   int32   eventId[nEvents]
+///   uint32  hitOffset[nEvents + 1]   (first hit of each event in the block)
+///   uint32  channel[nHits]           (packed ChannelId)
+///   uint32  photoelectrons[nHits]
+///   float   time[nHits]              (first arrival time, ns)
+///
+/// On close, a block index (one BlockIndex per block) and an IndexTrailer
+/// are appended, so a reader can seek to the blocks of an event range
+/// without reading the rest of the file. A file without index (e.g. from
+/// a crashed job) is still readable by scanning the block headers.
+///
+/// With compression enabled, the columns of a block are deflated as a
+/// whole with zlib and the block has the kCompressed flag; payloadSize is
+/// then the size on disk. Blocks that do not shrink are stored as they are.
+///
+/// The format does not depend on Geant4, so that the merge tool can be
+/// built on its own. Everything is in native byte order.
+
+namespace EventFormat
+{
+  const std::uint32_t kFileMagic = 0x5645554d;   // "MUEV"
+  const std::uint32_t kBlockMagic = 0x4b4c424d;  // "MBLK"
+  const std::uint32_t kIndexMagic = 0x58444e49;  // "INDX"
+  const std::uint32_t kVersion = 1;
+
+  // BlockHeader flags
+  const std::uint32_t kCompressed = 1;
+
+  struct FileHeader
+  {
+    std::uint32_t magic;
+    std::uint32_t version;
+  };
+
+  struct BlockHeader
+  {
+    std::uint32_t magic;
+    std::uint32_t nEvents;
+    std::uint32_t nHits;
+    std::uint32_t flags;
+    std::uint64_t payloadSize;  // bytes following this header
+  };
+
+  struct BlockIndex
+  {
+    std::uint64_t offset;       // of the BlockHeader in the file
+    std::uint64_t firstEvent;   // ordinal of the first event in the file
+    std::uint32_t nEvents;
+    std::uint32_t nHits;
+  };
+
+  struct IndexTrailer
+  {
+    std::uint64_t indexOffset;
+    std::uint64_t nBlocks;
+    std::uint32_t magic;
+    std::uint32_t reserved;
+  };
+
+  /// Columns of a range of events
+  struct EventColumns
+  {
+    std::vector<std::int32_t> eventId;
+    std::vector<std::uint32_t> hitOffset;  // nEvents + 1 entries
+    std::vector<std::uint32_t> channel;
+    std::vector<std::uint32_t> photoelectrons;
+    std::vector<float> time;
+
+    std::size_t GetNEvents() const { return eventId.size(); }
+    std::size_t GetNHits() const { return channel.size(); }
+    void Clear();
+    // appends the events [first, first + count) of one block
+    void AppendBlock(const BlockHeader& header, const char* payload,
+                     std::size_t first, std::size_t count);
+  };
+
+  // size of the uncompressed columns of a block
+  std::uint64_t GetPayloadSize(std::uint32_t nEvents, std::uint32_t nHits);
+
+  // true when the library was built with zlib
+  bool HasCompression();
+
+  /// Buffered writer of one file
+  class Writer
+  {
+    public:
+      Writer();
+      ~Writer();
+
+      bool Open(const std::string& fileName);
+      void Close();
+      bool IsOpen() const { return fFile != nullptr; }
+
+      // zlib level 1-9, 0 for no compression
+      void SetCompressionLevel(int level) { fCompressionLevel = level; }
+
+      void BeginEvent(std::int32_t eventId);
+      void AddHit(std::uint32_t channel, std::uint32_t photoelectrons,
+                  float time)
+      {
+        fColumns.channel.push_back(channel);
+        fColumns.photoelectrons.push_back(photoelectrons);
+        fColumns.time.push_back(time);
+      }
+      void EndEvent();
+
+      std::uint64_t GetNEvents() const { return fNEvents; }
+      std::uint64_t GetNHits() const { return fNHits; }
+      std::uint64_t GetBytesWritten() const { return fOffset; }
+      std::uint64_t GetUncompressedBytes() const { return fUncompressedBytes; }
+
+    private:
+      void FlushBlock();
+
+      std::FILE* fFile;
+      std::vector<char> fFileBuffer;
+      std::vector<char> fPayload;
+      std::vector<char> fCompressed;
+      int fCompressionLevel;
+      std::uint64_t fUncompressedBytes;
+      EventColumns fColumns;
+      std::vector<BlockIndex> fIndex;
+      std::uint64_t fOffset;
+      std::uint64_t fNEvents;
+      std::uint64_t fNHits;
+  };
+
+  /// Lazy reader of one file
+  class Reader
+  {
+    public:
+      Reader();
+      ~Reader();
+
+      bool Open(const std::string& fileName);
+      void Close();
+
+      std::uint64_t GetNEvents() const;
+      const std::vector<BlockIndex>& GetIndex() const { return fIndex; }
+
+      /// reads the events [first, first + count) into columns
+      bool Read(std::uint64_t first, std::uint64_t count,
+                EventColumns& columns);
+      /// reads the bytes of one block as stored, header included
+      bool ReadBlock(std::size_t block, std::vector<char>& bytes);
+      /// inflates a compressed block read by ReadBlock in place
+      static bool DecodeBlock(std::vector<char>& bytes);
+
+    private:
+      bool ReadIndex();
+      bool ScanBlocks();
+
+      std::FILE* fFile;
+      std::vector<BlockIndex> fIndex;
+  };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
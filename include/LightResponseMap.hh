@@ -0,0 +1,117 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file LightResponseMap.hh
+/// \brief Definition of the LightResponseMap class
+
+#ifndef LightResponseMap_h
+#define LightResponseMap_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <vector>
+
+/// Binned strip optical response.
+///
+/// The map covers one strip of half-length fHalfLength and half-width
+/// fHalfWidth on a grid of nAlong x nAcross cells (position along the
+/// strip, transverse offset). For each cell and SiPM end it holds the
+/// mean and variance of the detected photons, the mean visible energy
+/// deposited by the calibration muons and the mean and rms of the first
+/// photon arrival time relative to the crossing (MeV and ns in the file).
+///
+/// End 0 is the SiPM at -y, end 1 the SiPM at +y of the strip frame.
+/// A strip of another length is looked up by its distance to the SiPM,
+/// so the same map serves every strip template.
+///
+/// The binary file is
+///   char[8]  "MULRMAP1"
+///   int32    nAlong, nAcross
+///   float    halfLength, halfWidth (mm)
+///   Record   [nAlong][nAcross][2]
+/// in native byte order. Without a file, an analytic attenuation model
+/// fills the map.
+
+class LightResponseMap
+{
+  public:
+    struct Record
+    {
+      std::uint32_t events;
+      float meanPe;
+      float varPe;
+      float meanEdep;
+      float meanTime;
+      float rmsTime;
+    };
+
+    LightResponseMap();
+    ~LightResponseMap();
+
+    void SetGrid(G4int nAlong, G4int nAcross,
+                 G4double halfLength, G4double halfWidth);
+    void FillAnalytic();
+
+    G4bool Read(const G4String& fileName);
+    G4bool Write(const G4String& fileName) const;
+    // read from a calibration scan file rather than the analytic model
+    G4bool IsCalibrated() const { return fCalibrated; }
+
+    // cell access, as used by the calibration scan
+    G4int GetNAlong() const { return fNAlong; }
+    G4int GetNAcross() const { return fNAcross; }
+    G4int GetNCells() const { return fNAlong * fNAcross; }
+    G4double GetHalfLength() const { return fHalfLength; }
+    G4double GetHalfWidth() const { return fHalfWidth; }
+    G4double GetCellAlong(G4int cell) const;
+    G4double GetCellAcross(G4int cell) const;
+    Record& GetRecord(G4int cell, G4int end)
+      { return fRecords[2 * cell + end]; }
+    const Record& GetRecord(G4int cell, G4int end) const
+      { return fRecords[2 * cell + end]; }
+
+    /// record at the given distance from the SiPM of this end
+    const Record& Find(G4int end, G4double distance, G4double offset) const;
+
+    /// photoelectrons for a visible deposit, with the calibrated spread
+    G4int SamplePhotoelectrons(const Record& record,
+                               G4double visibleEdep) const;
+    /// first arrival time after the crossing
+    G4double SampleArrivalTime(const Record& record) const;
+
+  private:
+    G4int fNAlong;
+    G4int fNAcross;
+    G4double fHalfLength;
+    G4double fHalfWidth;
+    G4bool fCalibrated;
+    std::vector<Record> fRecords;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
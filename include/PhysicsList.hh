@@ -0,0 +1,69 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PhysicsList.hh
+/// \brief Definition of the PhysicsList class
+
+#ifndef PhysicsList_h
+#define PhysicsList_h 1
+
+#include "FTFP_BERT.hh"
+#include "globals.hh"
+
+/// Physics list: FTFP_BERT with EM option 4 and fast simulation, plus
+/// optical physics depending on the mode.
+///
+/// - full: scintillation, Cerenkov, WLS and boundary processes, the
+///   SiPMs count the optical photons (the original setup);
+/// - edep: no optical physics; the stepping action converts the visible
+///   (Birks-quenched) deposit of each scintillator step into
+///   photoelectrons with the light response map.
+///
+/// Both modes fill the same SiPM hits, so the output does not depend on
+/// the mode. The mode is chosen with exampleB1 -p full|edep.
+///
+/// The physics tables can be cached between jobs, see PhysicsTableCache.
+
+class PhysicsList : public FTFP_BERT
+{
+  public:
+    enum class Mode { kFull, kEdep };
+
+    PhysicsList(Mode mode, G4int photonBundleFactor = 1);
+    virtual ~PhysicsList();
+
+    Mode GetMode() const { return fMode; }
+
+    // "full" or "edep", returns false for an unknown name
+    static G4bool GetModeFromName(const G4String& name, Mode& mode);
+
+  private:
+    Mode fMode;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
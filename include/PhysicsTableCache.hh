@@ -0,0 +1,82 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PhysicsTableCache.hh
+/// \brief Definition of the PhysicsTableCache class
+
+#ifndef PhysicsTableCache_h
+#define PhysicsTableCache_h 1
+
+#include "G4VStateDependent.hh"
+#include "globals.hh"
+
+class G4VUserPhysicsList;
+class G4GenericMessenger;
+
+/// On-disk cache of the physics tables.
+///
+/// With /muon/physics/tableCache <directory> the tables built by the first
+/// run of a job are stored in <directory>/<key>, the key being a hash of
+/// the physics configuration, the Geant4 version, the production cuts of
+/// every region and the composition and density of every material. A
+/// later job with the same key retrieves the tables instead of building
+/// them; any change of the materials or cuts selects a new directory.
+/// Geant4 also compares the stored couples with the current ones and
+/// rebuilds if they differ. Only the EM tables can be retrieved, the
+/// hadronic and optical processes always build theirs.
+///
+/// The cache follows the master state changes: the key is computed when
+/// the first run initialization starts (Idle to Init), and the tables
+/// are stored, or retrieval is switched off, when it ends (Init to Idle),
+/// before the MT workers are started, so only the master reads or writes
+/// the files. It is owned by the state manager.
+
+class PhysicsTableCache : public G4VStateDependent
+{
+  public:
+    PhysicsTableCache(G4VUserPhysicsList* physicsList,
+                      const G4String& configuration);
+
+    virtual G4bool Notify(G4ApplicationState requestedState);
+
+  private:
+    virtual ~PhysicsTableCache();
+
+    G4String GetKey() const;
+    void Store();
+
+    G4VUserPhysicsList* fPhysicsList;
+    G4String fConfiguration;
+    G4GenericMessenger* fMessenger;
+    G4String fDirectory;
+    G4String fTableDirectory;
+    G4bool fConfigured;
+    G4bool fRetrieving;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -37,16 +37,29 @@
 class G4ParticleGun;
 class G4Event;
 class G4Box;
+class G4GenericMessenger;
+class CosmicMuonGenerator;
+class BarrelAcceptance;
+class RunAction;
 
 /// The primary generator action class with particle gun.
 ///
-/// The default kinematic is a 6 MeV gamma, randomly distribued 
-/// in front of the phantom across 80% of the (X,Y) phantom size.
+/// In the default "fixed" mode the gun fires the same 1024 MeV mu- every
+/// event. /muon/gun/mode cosmic samples sea-level cosmic muons with
+/// CosmicMuonGenerator instead. A running calibration scan overrides
+/// both.
+///
+/// Cosmic muons whose straight line misses the barrel are resampled
+/// before the event is built (/muon/gun/preselect). The number of
+/// samples drawn per event is passed to the run action, which converts
+/// it into the acceptance fraction and the live time of the run. If no
+/// sample crosses the barrel after a million trials, the event is
+/// aborted without a primary.
 
 class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
 {
   public:
-    PrimaryGeneratorAction();    
+    PrimaryGeneratorAction(RunAction* runAction);
     virtual ~PrimaryGeneratorAction();
 
     // method from the base class
@@ -56,8 +69,16 @@ class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
     const G4ParticleGun* GetParticleGun() const { return fParticleGun; }
   
   private:
+    void SetMode(G4String mode);
+
     G4ParticleGun*  fParticleGun; // pointer a to G4 gun class
     G4Box* fEnvelopeBox;
+    RunAction* fRunAction;
+    G4GenericMessenger* fMessenger;
+    CosmicMuonGenerator* fCosmicGenerator;
+    BarrelAcceptance* fAcceptance;
+    G4bool fCosmic;
+    G4bool fPreselect;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
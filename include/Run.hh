@@ -0,0 +1,101 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file Run.hh
+/// \brief Definition of the Run class
+
+#ifndef Run_h
+#define Run_h 1
+
+#include "StepProfile.hh"
+
+#include "G4Run.hh"
+#include "globals.hh"
+
+#include <vector>
+
+/// Run class
+///
+/// Holds the per-thread sums of the calibration scan, one entry per grid
+/// cell, which are merged into the master run at the end of the run,
+/// and the stepping profile (StepProfiler).
+///
+/// It also holds the per-channel hit counts, photoelectron sums and sums
+/// of squares and counts above threshold, and the per-strip crossings and
+/// detections (both ends above threshold), in flat arrays indexed by the
+/// dense ChannelId indices. The event action fills those of its thread
+/// without locks; they are added once in Merge().
+
+class Run : public G4Run
+{
+  public:
+    struct CellSums
+    {
+      G4double events = 0.;
+      G4double visibleEdep = 0.;
+      G4double pe[2] = { 0., 0. };
+      G4double pe2[2] = { 0., 0. };
+      G4double timeEntries[2] = { 0., 0. };
+      G4double time[2] = { 0., 0. };
+      G4double time2[2] = { 0., 0. };
+    };
+
+    Run();
+    virtual ~Run();
+
+    virtual void Merge(const G4Run*);
+
+    void AddCalibrationEvent(G4int cell, const G4int pe[2],
+                             const G4double time[2], G4double visibleEdep);
+    const std::vector<CellSums>& GetCalibrationSums() const
+      { return fCalibrationSums; }
+
+    void AddChannelHit(G4int channel, G4int photoelectrons,
+                       G4bool aboveThreshold);
+    void AddStripCrossing(G4int strip, G4bool detected);
+    // per-strip efficiency and light yield, returns false if not written
+    G4bool WriteStripResponse(const G4String& fileName) const;
+
+    StepProfile& GetStepProfile() { return fStepProfile; }
+    const StepProfile& GetStepProfile() const { return fStepProfile; }
+
+  private:
+    std::vector<CellSums> fCalibrationSums;
+
+    // per channel
+    std::vector<G4double> fChannelHits;
+    std::vector<G4double> fChannelPe;
+    std::vector<G4double> fChannelPe2;
+    std::vector<G4double> fChannelAbove;
+    // per strip
+    std::vector<G4double> fStripCrossed;
+    std::vector<G4double> fStripDetected;
+    StepProfile fStepProfile;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
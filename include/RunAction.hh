@@ -32,15 +32,33 @@
 
 #include "G4UserRunAction.hh"
 #include "G4Accumulable.hh"
+#include "G4Timer.hh"
+#include "AsyncEventWriter.hh"
 #include "globals.hh"
 
 class G4Run;
+class G4GenericMessenger;
 
 /// Run action class
 ///
-/// In EndOfRunAction(), it calculates the dose in the selected volume 
-/// from the energy deposit accumulated via stepping and event actions.
-/// The computed dose is then printed on the screen.
+/// In EndOfRunAction(), it prints the run wall time, the event rate,
+/// the mean number of fired SiPM channels and the mean and rms of the
+/// photoelectrons per event
+/// and the number of optical photon boundary steps accumulated via
+/// stepping and event actions.
+///
+/// When /muon/output/fileName is set, each thread that processes events
+/// writes the SiPM hits to its own columnar event file
+/// <fileName>_run<N>_t<thread>.mev; the shards are combined with the
+/// muon_merge tool. The files are written by an AsyncEventWriter, so the
+/// event loop does not wait on the storage; the queue depth, stall time
+/// and bytes written are printed by each worker at the end of the run.
+///
+/// When /muon/output/stripResponseFile is set, the master also writes
+/// the per-strip efficiency (crossings with both SiPMs at or above
+/// /muon/output/peThreshold over crossings with at least
+/// /muon/output/crossingEdep in the strip) and the mean and rms
+/// photoelectrons of every channel to <stripResponseFile>_run<N>.csv.
 
 class RunAction : public G4UserRunAction
 {
@@ -48,12 +66,44 @@ class RunAction : public G4UserRunAction
     RunAction();
     virtual ~RunAction();
 
-    // virtual G4Run* GenerateRun();
+    virtual G4Run* GenerateRun();
     virtual void BeginOfRunAction(const G4Run*);
     virtual void   EndOfRunAction(const G4Run*);
 
+    void AddOpticalBoundarySteps(G4double n) { fOpticalBoundarySteps += n; }
+    void AddOpticalTracks(G4double n) { fOpticalTracks += n; }
+    void AddSiPMHits(G4int channels, G4int photoelectrons);
+    void AddSiPMCells(G4int cells);
+    void AddGeneratedMuons(G4int trials, G4double liveTime)
+      { fGeneratedMuons += trials; fLiveTime += liveTime; }
+
+    G4double GetPeThreshold() const { return fPeThreshold; }
+    G4double GetCrossingEdep() const { return fCrossingEdep; }
+
+    AsyncEventWriter* GetEventWriter()
+      { return fEventWriter.IsOpen() ? &fEventWriter : nullptr; }
 
   private:
+    G4Accumulable<G4double> fOpticalBoundarySteps;
+    G4Accumulable<G4double> fOpticalTracks;
+    G4Accumulable<G4int> fFiredChannels;
+    G4Accumulable<G4double> fPhotoelectrons;
+    G4Accumulable<G4double> fPhotoelectrons2;
+    G4Accumulable<G4int> fDigitizedEvents;
+    G4Accumulable<G4double> fCells;
+    G4Accumulable<G4double> fCells2;
+    G4Accumulable<G4double> fGeneratedMuons;
+    G4Accumulable<G4double> fLiveTime;
+    G4Timer fTimer;
+
+    G4GenericMessenger* fMessenger;
+    G4String fOutputFileName;
+    G4int fOutputQueueDepth;
+    G4int fOutputCompression;
+    G4String fStripResponseFile;
+    G4double fPeThreshold;
+    G4double fCrossingEdep;
+    AsyncEventWriter fEventWriter;
 };
 
 #endif
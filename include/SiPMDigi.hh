@@ -0,0 +1,93 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file SiPMDigi.hh
+/// \brief Definition of the SiPMDigi class
+
+#ifndef SiPMDigi_h
+#define SiPMDigi_h 1
+
+#include "G4VDigi.hh"
+#include "G4TDigiCollection.hh"
+#include "G4Allocator.hh"
+#include "globals.hh"
+
+/// SiPM digi
+///
+/// One digi per SiPM channel above threshold after SiPMDigitizer.
+/// It records:
+/// - the dense channel index (see ChannelId)
+/// - the number of fired cells (signal, dark counts and crosstalk)
+/// - the charge, afterpulses and gain fluctuations included
+/// - the time of the first avalanche
+
+class SiPMDigi : public G4VDigi
+{
+  public:
+    SiPMDigi(G4int channel, G4int avalanches, G4double charge, G4double time);
+    virtual ~SiPMDigi();
+
+    inline void* operator new(size_t);
+    inline void  operator delete(void*);
+
+    virtual void Print();
+
+    G4int GetChannel() const { return fChannel; }
+    G4int GetAvalanches() const { return fAvalanches; }
+    G4double GetCharge() const { return fCharge; }
+    G4double GetTime() const { return fTime; }
+
+  private:
+    G4int fChannel;
+    G4int fAvalanches;
+    G4double fCharge;
+    G4double fTime;
+};
+
+using SiPMDigiCollection = G4TDigiCollection<SiPMDigi>;
+
+extern G4ThreadLocal G4Allocator<SiPMDigi>* SiPMDigiAllocator;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void* SiPMDigi::operator new(size_t)
+{
+  if (!SiPMDigiAllocator) {
+       SiPMDigiAllocator = new G4Allocator<SiPMDigi>;
+  }
+  return (void*)SiPMDigiAllocator->MallocSingle();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void SiPMDigi::operator delete(void* aDigi)
+{
+  SiPMDigiAllocator->FreeSingle((SiPMDigi*) aDigi);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
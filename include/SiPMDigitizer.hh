@@ -0,0 +1,126 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file SiPMDigitizer.hh
+/// \brief Definition of the SiPMDigitizer class
+
+#ifndef SiPMDigitizer_h
+#define SiPMDigitizer_h 1
+
+#include "G4VDigitizerModule.hh"
+#include "SiPMHit.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4GenericMessenger;
+class G4LogicalVolume;
+class G4VPhysicalVolume;
+
+/// SiPM digitizer module
+///
+/// Converts the photons of the SiPM hits to the SiPMDigi collection
+/// "SiPMDigitizer/SiPMDigiColl":
+/// - signal cells: each tracked photon of a band is detected with the
+///   photon detection efficiency (PDE) of the band, a binomial thinning;
+///   the photoelectrons of the parametrised light models count
+///   calibrated photons too and are thinned with the PDE of the fibre
+///   emission band. The hits keep the undetected counts, so the run
+///   statistics do not depend on the digitization. With photon bundling
+///   a bundle of N photons fires one cell with probability N PDE, which
+///   gives the Poisson statistics of unbundled running as long as
+///   N PDE <= 1; above, it fires floor(N PDE) or one more cell.
+/// - dark counts: Poisson over the integration window on every channel
+///   of the built geometry, sampled sparsely as one total count spread
+///   over random channels, at random times in the window
+/// - optical crosstalk: each cell fires further cells with probability
+///   p, approximated by a Poisson of mean n p / (1 - p)
+/// - afterpulses: binomial with probability p_ap per cell, each adding
+///   a fraction of a cell to the charge
+/// - charge: gain times the elementary charge per cell, with a Gaussian
+///   gain spread per cell; channels below threshold are dropped
+///
+/// The fired channels are kept in compact structure-of-arrays batches
+/// (a channel to slot map is reset after each event) and the random
+/// numbers are drawn first, so the cost of an event scales with the
+/// fired channels, not with all channels of the barrel.
+///
+/// The module is disabled by default; /muon/sipm/digitize enables it.
+
+class SiPMDigitizer : public G4VDigitizerModule
+{
+  public:
+    SiPMDigitizer(G4String name);
+    virtual ~SiPMDigitizer();
+
+    // collects the channels of the built geometry, at the start of
+    // each run as the geometry may have been rebuilt
+    void BeginOfRun();
+    virtual void Digitize();
+
+    G4bool IsEnabled() const { return fEnabled; }
+
+  private:
+    void DefineCommands();
+    void SetPde(G4String value);
+    void CollectChannels(const G4LogicalVolume* volume,
+                         G4int envelope, G4int layer);
+    G4int GetSlot(G4int channel, G4double time);
+    G4int DetectBundles(G4long bundles, G4int bundleFactor,
+                        G4double pde) const;
+
+    G4GenericMessenger* fMessenger;
+    G4bool fEnabled;
+    G4int fHCID;
+    G4int fModelBand;
+
+    // parameters
+    G4double fPde[SiPMHit::kNBands];
+    G4double fDarkRate;
+    G4double fWindow;
+    G4double fCrosstalk;
+    G4double fAfterpulse;
+    G4double fAfterpulseCharge;   // fraction of a cell
+    G4double fGain;
+    G4double fGainSpread;         // relative, per cell
+    G4double fThreshold;          // cells
+
+    // channels of the built geometry, indexed by ChannelId::ToIndex
+    std::vector<char> fValidChannel;
+
+    // fired channels of the event, structure of arrays
+    std::vector<G4int> fSlot;         // per channel, -1 if not fired
+    std::vector<G4int> fChannel;
+    std::vector<G4double> fTime;
+    std::vector<G4int> fAvalanches;
+    std::vector<G4int> fAfterpulses;
+    std::vector<G4double> fGauss;
+    std::vector<G4double> fCharge;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
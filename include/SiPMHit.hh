@@ -0,0 +1,112 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file SiPMHit.hh
+/// \brief Definition of the SiPMHit class
+
+#ifndef SiPMHit_h
+#define SiPMHit_h 1
+
+#include "G4VHit.hh"
+#include "G4THitsCollection.hh"
+#include "G4Allocator.hh"
+#include "globals.hh"
+
+#include <array>
+
+/// SiPM hit
+///
+/// One hit per SiPM channel that detected at least one photon in the
+/// event. It records:
+/// - the dense channel index (see ChannelId)
+/// - the number of photoelectrons, and those of the parametrised models
+/// - the arrival time of the first photon
+/// - the tracked photons in wavelength bands of 50 nm from 300 nm,
+///   from which SiPMDigitizer applies the photon detection efficiency;
+///   single photons and photon bundles (tracks of weight N, the bundle
+///   factor) are counted apart
+
+class SiPMHit : public G4VHit
+{
+  public:
+    static const G4int kNBands = 8;
+
+    SiPMHit(G4int channel, G4int npe, G4int modelPe, G4double time,
+            const G4float* bandPhotons, const G4float* bandBundles,
+            G4int bundleFactor);
+    virtual ~SiPMHit();
+
+    inline void* operator new(size_t);
+    inline void  operator delete(void*);
+
+    virtual void Print();
+
+    G4int GetChannel() const { return fChannel; }
+    G4int GetPhotoelectrons() const { return fPhotoelectrons; }
+    G4int GetModelPhotoelectrons() const { return fModelPhotoelectrons; }
+    G4double GetTime() const { return fTime; }
+    G4float GetBandPhotons(G4int band) const { return fBandPhotons[band]; }
+    G4float GetBandBundles(G4int band) const { return fBandBundles[band]; }
+    G4int GetBundleFactor() const { return fBundleFactor; }
+
+    // wavelength band of a photon, and the wavelength at the band centre
+    static G4int GetBand(G4double photonEnergy);
+    static G4double GetBandWavelength(G4int band);
+
+  private:
+    G4int fChannel;
+    G4int fPhotoelectrons;
+    G4int fModelPhotoelectrons;
+    G4double fTime;
+    std::array<G4float, kNBands> fBandPhotons;
+    std::array<G4float, kNBands> fBandBundles;
+    G4int fBundleFactor;
+};
+
+using SiPMHitsCollection = G4THitsCollection<SiPMHit>;
+
+extern G4ThreadLocal G4Allocator<SiPMHit>* SiPMHitAllocator;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void* SiPMHit::operator new(size_t)
+{
+  if (!SiPMHitAllocator) {
+       SiPMHitAllocator = new G4Allocator<SiPMHit>;
+  }
+  return (void*)SiPMHitAllocator->MallocSingle();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void SiPMHit::operator delete(void* aHit)
+{
+  SiPMHitAllocator->FreeSingle((SiPMHit*) aHit);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,96 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file SiPMSD.hh
+/// \brief Definition of the SiPMSD class
+
+#ifndef SiPMSD_h
+#define SiPMSD_h 1
+
+#include "G4VSensitiveDetector.hh"
+#include "SiPMHit.hh"
+
+#include <vector>
+
+class G4Step;
+class G4HCofThisEvent;
+class G4TouchableHistory;
+class G4ParticleDefinition;
+
+/// SiPM sensitive detector class
+///
+/// Counts the optical photons reaching the SiPM volumes. Photoelectrons
+/// and first arrival times are kept in flat per-thread arrays indexed by
+/// the dense ChannelId index, allocated once; a hit is created at the end of the event only
+/// for the channels that fired, so nothing is allocated per photon.
+///
+/// Optical photons are summed with their track weight. With photon
+/// bundling (bundle factor N > 1) each scintillation photon, and the WLS
+/// photons it makes, stands for N photons, so the weight sum of a
+/// channel is an unbiased count, with N times the Poisson variance. No
+/// function of that count alone has a smaller one. The statistics are
+/// unbundled where the photons are detected: per wavelength band
+/// (SiPMHit::GetBand) the single photons and the bundles are counted
+/// apart, and SiPMDigitizer detects each bundle once with N times the
+/// PDE, which gives the photoelectron statistics of unbundled running
+/// (bench/check_bundling.py compares both). The photoelectrons of
+/// the parametrised models are kept apart, in units of calibrated
+/// photons as well; the digitizer applies the PDE of the fibre emission
+/// band to them.
+
+class SiPMSD : public G4VSensitiveDetector
+{
+  public:
+    SiPMSD(G4String name, G4int bundleFactor = 1);
+    virtual ~SiPMSD();
+
+    virtual void Initialize(G4HCofThisEvent* HCE);
+    virtual G4bool ProcessHits(G4Step* step, G4TouchableHistory* history);
+    virtual void EndOfEvent(G4HCofThisEvent* HCE);
+
+    // also used by the parametrised light models
+    void AddPhotoelectrons(G4int channel, G4int npe, G4double time);
+
+  private:
+    void AddPhotons(G4int channel, G4int band, G4double weight,
+                    G4double time);
+
+    SiPMHitsCollection* fHitsCollection;
+    G4int fHCID;
+    G4ParticleDefinition* fOpticalPhoton;
+    G4int fBundleFactor;
+
+    std::vector<G4int> fPhotoelectrons;
+    std::vector<G4double> fPhotonWeights;
+    std::vector<G4double> fFirstTime;
+    std::vector<G4float> fBandPhotons;   // kNBands entries per channel
+    std::vector<G4float> fBandBundles;   // kNBands entries per channel
+    std::vector<G4int> fFiredChannels;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
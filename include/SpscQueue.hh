@@ -0,0 +1,96 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file SpscQueue.hh
+/// \brief Definition of the SpscQueue class template
+
+#ifndef SpscQueue_h
+#define SpscQueue_h 1
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/// Bounded lock-free queue for one producer and one consumer thread.
+///
+/// The capacity is rounded up to a power of two. Elements are moved in
+/// and out, so a record holding vectors is handed over without copying
+/// its contents. The head and tail counters live on separate cache lines
+/// to avoid false sharing between the two threads.
+
+template <typename T>
+class SpscQueue
+{
+  public:
+    explicit SpscQueue(std::size_t capacity)
+    : fHead(0), fTail(0)
+    {
+      std::size_t size = 1;
+      while ( size < capacity ) size <<= 1;
+      fSlots.resize(size);
+      fMask = size - 1;
+    }
+
+    std::size_t GetCapacity() const { return fSlots.size(); }
+
+    // number of queued elements, approximate while the other thread runs
+    std::size_t GetSize() const
+      { return fTail.load(std::memory_order_acquire)
+             - fHead.load(std::memory_order_acquire); }
+
+    // producer side, value is moved from only when it is queued
+    bool TryPush(T&& value)
+    {
+      std::size_t tail = fTail.load(std::memory_order_relaxed);
+      if ( tail - fHead.load(std::memory_order_acquire) == fSlots.size() ) {
+        return false;
+      }
+      fSlots[tail & fMask] = std::move(value);
+      fTail.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    // consumer side
+    bool TryPop(T& value)
+    {
+      std::size_t head = fHead.load(std::memory_order_relaxed);
+      if ( head == fTail.load(std::memory_order_acquire) ) return false;
+      value = std::move(fSlots[head & fMask]);
+      fHead.store(head + 1, std::memory_order_release);
+      return true;
+    }
+
+  private:
+    std::vector<T> fSlots;
+    std::size_t fMask;
+    alignas(64) std::atomic<std::size_t> fHead;
+    alignas(64) std::atomic<std::size_t> fTail;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
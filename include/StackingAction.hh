@@ -0,0 +1,107 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file StackingAction.hh
+/// \brief Definition of the StackingAction class
+
+#ifndef StackingAction_h
+#define StackingAction_h 1
+
+#include "G4UserStackingAction.hh"
+#include "DeferredStripLight.hh"
+#include "globals.hh"
+
+class EventAction;
+class G4GenericMessenger;
+class G4Material;
+class G4ParticleDefinition;
+class LightResponseMap;
+class SiPMSD;
+
+/// Stacking action class
+///
+/// Two-stage tracking of the optical photons. In the first stage the
+/// optical photons are put in the waiting stack, so the muon and its
+/// charged secondaries are transported first and the event action sums
+/// the energy deposited in each strip. At the start of the second stage
+/// the waiting photons are classified again: those born in a strip whose
+/// deposit reached /muon/stacking/stripThreshold are tracked, the others
+/// are killed. Photons born outside the strips are always tracked.
+///
+/// The calibration scan tracks all photons. /muon/stacking/deferOptical
+/// false restores single-stage tracking.
+///
+/// With /muon/stacking/stripLightThreads N > 0 the photons of the strips
+/// above threshold are parametrised instead of tracked. They are grouped
+/// by strip and converted to photoelectrons with the light response map
+/// (DeferredStripLight), on a pool of N helper threads shared by all
+/// workers. This needs a calibrated map
+/// (/muon/detector/lightResponseMap); with the analytic default the
+/// photons are tracked and a warning is issued. Photons born outside the
+/// strips are always tracked.
+/// Only the scintillation photons are converted; the map already holds
+/// the Cerenkov and WLS light of the calibration per visible deposit, so
+/// the other photons of these strips are dropped. The scintillation
+/// photons carry the photon bundle factor as weight, as the tracking
+/// action gives it to the tracked ones. Those born during the optical
+/// stage wait for a further stage and are converted before the event
+/// ends.
+
+class StackingAction : public G4UserStackingAction
+{
+  public:
+    StackingAction(EventAction* eventAction, G4int bundleFactor = 1);
+    virtual ~StackingAction();
+
+    virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track*);
+    virtual void NewStage();
+    virtual void PrepareNewEvent();
+
+  private:
+    G4bool UseStripLightModel();
+
+    EventAction* fEventAction;
+    G4int fBundleFactor;
+    G4GenericMessenger* fMessenger;
+    G4ParticleDefinition* fOpticalPhoton;
+
+    G4bool fDeferOptical;
+    G4double fStripThreshold;
+    G4bool fOpticalStage;
+    G4bool fReclassifying;
+
+    G4int fStripLightThreads;
+    DeferredStripLight fStripLight;
+    const LightResponseMap* fResponseMap;
+    SiPMSD* fSiPMSD;
+    const G4Material* fScintillator;
+    G4double fPhotonsPerMeV;
+    G4bool fWarnedUncalibrated;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
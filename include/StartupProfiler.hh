@@ -0,0 +1,97 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file StartupProfiler.hh
+/// \brief Definition of the StartupProfiler class
+
+#ifndef StartupProfiler_h
+#define StartupProfiler_h 1
+
+#include "G4VStateDependent.hh"
+#include "globals.hh"
+
+#include <chrono>
+#include <vector>
+
+class G4GenericMessenger;
+
+/// Timing and memory of the job startup phases.
+///
+/// Each phase records the wall and CPU time since the end of the previous
+/// one and the peak resident memory at its end. The phases are closed
+/// explicitly (run manager, materials, user classes, geometry) or on the
+/// master state changes of the Geant4 kernel (physics construction,
+/// physics tables and voxelization, worker initialization); the time
+/// spent waiting in the PreInit and Idle states for commands is not
+/// counted. The table is printed at the first master BeginOfRunAction
+/// and, with /muon/profile/startupFile, also written as JSON.
+///
+/// The profiler lives on the master; it is owned by the state manager.
+
+class StartupProfiler : public G4VStateDependent
+{
+  public:
+    static StartupProfiler* Instance();
+
+    // record the phase since the end of the previous one
+    void EndPhase(const G4String& name);
+    // print the table and write the JSON file, only the first time
+    void Report();
+
+    virtual G4bool Notify(G4ApplicationState requestedState);
+
+  private:
+    struct Sample {
+      std::chrono::steady_clock::time_point wall;
+      G4double cpu;      // process user + system time [s]
+      G4double peakRss;  // peak resident memory [MB]
+    };
+    struct Phase {
+      G4String name;
+      G4double wall;
+      G4double cpu;
+      G4double peakRss;
+    };
+
+    StartupProfiler();
+    virtual ~StartupProfiler();
+
+    static Sample TakeSample();
+    void Restart() { fLast = TakeSample(); }
+    void WriteJson() const;
+
+    G4GenericMessenger* fMessenger;
+    G4String fFileName;
+    std::chrono::steady_clock::time_point fStart;
+    Sample fLast;
+    std::vector<Phase> fPhases;
+    G4int fNInitPhases;
+    G4bool fReported;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,95 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file StepProfile.hh
+/// \brief Definition of the StepProfile class
+
+#ifndef StepProfile_h
+#define StepProfile_h 1
+
+#include "VolumeRoles.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4ParticleDefinition;
+
+/// Particle classes of the step profile.
+
+enum class ParticleKind : G4int
+{
+  kOpticalPhoton = 0,
+  kGamma,
+  kElectron,       // e- and e+
+  kMuon,
+  kChargedHadron,
+  kNeutron,
+  kIon,
+  kOther,
+  kNumKinds
+};
+
+/// Tracks, steps and sampled stepping time per (volume role, particle
+/// kind), in flat tables filled by StepProfiler. Each Run holds one; the
+/// worker profiles are merged into the master run, which prints the
+/// cells ranked by time. The optical photon steps that end on a volume
+/// boundary are also counted and timed on their own, for the cost of
+/// the boundary process and the surface lookup.
+
+class StepProfile
+{
+  public:
+    StepProfile();
+
+    static ParticleKind GetKind(const G4ParticleDefinition* particle);
+    static const char* GetKindName(ParticleKind kind);
+
+    static std::size_t GetCell(VolumeRole role, ParticleKind kind)
+      { return std::size_t(role) * std::size_t(ParticleKind::kNumKinds)
+               + std::size_t(kind); }
+
+    void AddTrack(std::size_t cell) { fTracks[cell] += 1.; }
+    void AddStep(std::size_t cell) { fSteps[cell] += 1.; }
+    void AddTime(std::size_t cell, G4double seconds)
+      { fTime[cell] += seconds; }
+    void AddBoundaryStep() { fBoundarySteps += 1.; }
+    void AddBoundaryTime(G4double seconds) { fBoundaryTime += seconds; }
+
+    G4bool IsEmpty() const;
+    void Merge(const StepProfile& other);
+    void Print(std::size_t maxRows = 20) const;
+
+  private:
+    std::vector<G4double> fTracks;
+    std::vector<G4double> fSteps;
+    std::vector<G4double> fTime;   // sampled, scaled to all steps [s]
+    G4double fBoundarySteps;       // optical photon steps to a boundary
+    G4double fBoundaryTime;        // their sampled, scaled time [s]
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
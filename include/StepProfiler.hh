@@ -0,0 +1,101 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file StepProfiler.hh
+/// \brief Definition of the StepProfiler class
+
+#ifndef StepProfiler_h
+#define StepProfiler_h 1
+
+#include "StepProfile.hh"
+#include "globals.hh"
+
+#include <chrono>
+
+class G4GenericMessenger;
+class G4Track;
+
+/// Per-thread step profiler, shared by the tracking and stepping actions.
+///
+/// When enabled (/muon/profile/steps/enable) every track is counted in the
+/// role of its start volume and every step in the role of its pre-step
+/// volume, with the particle kind of the track, into the StepProfile of
+/// the current run. The time of one step in samplingPeriod is measured
+/// between two consecutive stepping actions of the same track and scaled
+/// by the period. The optical photon steps that end on a volume boundary
+/// are also accumulated on their own. When disabled the actions only
+/// test a flag.
+
+class StepProfiler
+{
+  public:
+    StepProfiler();
+    ~StepProfiler();
+
+    G4bool IsEnabled() const { return fEnabled; }
+
+    void BeginTrack(const G4Track* track);
+    void Step(VolumeRole role, G4bool boundary);
+
+  private:
+    G4GenericMessenger* fMessenger;
+    G4bool fEnabled;
+    G4int fSamplingPeriod;
+
+    StepProfile* fProfile;
+    ParticleKind fKind;
+    G4int fStepCounter;
+    G4bool fSampling;
+    std::chrono::steady_clock::time_point fSampleStart;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline void StepProfiler::Step(VolumeRole role, G4bool boundary)
+{
+  std::size_t cell = StepProfile::GetCell(role, fKind);
+  fProfile->AddStep(cell);
+  boundary = boundary && fKind == ParticleKind::kOpticalPhoton;
+  if ( boundary ) fProfile->AddBoundaryStep();
+
+  if ( fSampling ) {
+    std::chrono::duration<G4double> elapsed
+      = std::chrono::steady_clock::now() - fSampleStart;
+    G4double time = elapsed.count() * fSamplingPeriod;
+    fProfile->AddTime(cell, time);
+    if ( boundary ) fProfile->AddBoundaryTime(time);
+    fSampling = false;
+  }
+  if ( ++fStepCounter >= fSamplingPeriod ) {
+    fStepCounter = 0;
+    fSampling = true;
+    fSampleStart = std::chrono::steady_clock::now();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
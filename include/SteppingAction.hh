@@ -33,24 +33,51 @@
 #include "G4UserSteppingAction.hh"
 #include "globals.hh"
 
+#include <cstdint>
+
 class EventAction;
+class StepProfiler;
+class G4VTouchable;
 
 class G4LogicalVolume;
+class G4ParticleDefinition;
+class LightResponseMap;
+class SiPMSD;
 
 /// Stepping action class
-/// 
+///
+/// Applies the surface loss and SiPM absorption to optical photons and
+/// sums the energy deposited by the other particles in each strip.
+///
+/// In the energy-deposit physics mode there are no optical photons;
+/// the visible deposit of each step in the scintillator is converted
+/// into photoelectrons at both strip ends with the light response map
+/// and added to the SiPM sensitive detector.
+/// Volumes are identified through VolumeRoles and particles by their
+/// definition pointer, so no string is compared per step.
+///
+/// Every step is passed to the StepProfiler when it is enabled.
 
 class SteppingAction : public G4UserSteppingAction
 {
   public:
-    SteppingAction(EventAction* eventAction);
+    SteppingAction(EventAction* eventAction, StepProfiler* stepProfiler,
+                   G4bool edepMode = false);
     virtual ~SteppingAction();
 
     // method from the base class
     virtual void UserSteppingAction(const G4Step*);
 
   private:
+    void DigitizeStep(const G4Step* step, const G4VTouchable* touchable,
+                      G4int stripDepth, std::uint32_t stripId);
+
     EventAction*  fEventAction;
+    StepProfiler* fStepProfiler;
+    G4ParticleDefinition* fOpticalPhoton;
+    G4bool fEdepMode;
+    const LightResponseMap* fResponseMap;
+    SiPMSD* fSiPMSD;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
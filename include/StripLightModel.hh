@@ -0,0 +1,89 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file StripLightModel.hh
+/// \brief Definition of the StripLightModel class
+
+#ifndef StripLightModel_h
+#define StripLightModel_h 1
+
+#include "G4VFastSimulationModel.hh"
+#include "G4EmCalculator.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <cstdint>
+
+class G4Material;
+class LightResponseMap;
+class SiPMSD;
+
+/// Fast simulation light-yield model for the scintillator strips.
+///
+/// Attached to the strip region, it takes over charged particles that
+/// cross a strip: the particle is moved in a straight line to the strip
+/// exit with its mean energy loss, the visible (Birks-quenched) deposit
+/// is converted to photoelectrons and first arrival times at both SiPMs
+/// with the LightResponseMap, and the result is added to the SiPM
+/// sensitive detector. No optical photon is generated. Particles that
+/// would stop inside the strip are left to the full simulation.
+///
+/// AddStripLight() is the conversion step alone; the energy-deposit
+/// physics mode uses it for every step in the scintillator.
+
+class StripLightModel : public G4VFastSimulationModel
+{
+  public:
+    StripLightModel(G4String name, G4Region* region,
+                    const LightResponseMap* responseMap, SiPMSD* sipmSD);
+    virtual ~StripLightModel();
+
+    virtual G4bool IsApplicable(const G4ParticleDefinition& particle);
+    virtual G4bool ModelTrigger(const G4FastTrack& fastTrack);
+    virtual void DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep);
+
+    // photoelectrons at both ends of a strip for a visible deposit at a
+    // position in the strip frame
+    static void AddStripLight(const LightResponseMap* responseMap,
+                              SiPMSD* sipmSD, std::uint32_t stripId,
+                              G4double halfLength,
+                              const G4ThreeVector& localPosition,
+                              G4double visibleEdep, G4double time);
+
+  private:
+    G4double GetEnergyLoss(const G4FastTrack& fastTrack,
+                           const G4Material* scintillator,
+                           G4double& pathLength);
+
+    const LightResponseMap* fResponseMap;
+    SiPMSD* fSiPMSD;
+    G4Region* fRegion;
+    G4EmCalculator fEmCalculator;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,96 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file TaskPool.hh
+/// \brief Definition of the TaskPool class
+
+#ifndef TaskPool_h
+#define TaskPool_h 1
+
+#include "globals.hh"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Process-wide pool of helper threads.
+///
+/// The threads are started once and shared by all Geant4 worker threads,
+/// so N helpers stay N helpers whatever the number of workers. Run()
+/// queues a batch of independent tasks, takes part in it on the calling
+/// thread and returns when every task of the batch is done; batches of
+/// several callers are served in order.
+///
+/// The pool only grows: Reserve() with fewer threads than are running
+/// keeps them until the end of the job, and it never starts more than
+/// the hardware threads of the machine.
+
+class TaskPool
+{
+  public:
+    static TaskPool* Instance();
+
+    // starts helper threads until there are at least nThreads, at most
+    // the number of hardware threads; running threads are not stopped
+    void Reserve(G4int nThreads);
+
+    // runs task(i) for i in [0, nTasks)
+    void Run(std::size_t nTasks, const std::function<void(std::size_t)>& task);
+
+  private:
+    TaskPool();
+    ~TaskPool();
+
+    struct Batch
+    {
+      const std::function<void(std::size_t)>* task;
+      std::size_t nTasks;
+      std::atomic<std::size_t> next;
+      std::size_t done;      // guarded by fMutex
+      G4int helpers;         // helpers working on it, guarded by fMutex
+    };
+
+    void Work();
+    std::size_t RunTasks(Batch& batch);
+    void Remove(Batch* batch);
+
+    std::mutex fMutex;
+    std::condition_variable fWakeUp;
+    std::condition_variable fFinished;
+    std::deque<Batch*> fBatches;
+    std::vector<std::thread> fThreads;
+    std::atomic<G4int> fNThreads;
+    G4bool fStop;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,64 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file TrackingAction.hh
+/// \brief Definition of the TrackingAction class
+
+#ifndef TrackingAction_h
+#define TrackingAction_h 1
+
+#include "G4UserTrackingAction.hh"
+#include "globals.hh"
+
+class G4ParticleDefinition;
+class StepProfiler;
+
+/// Tracking action class
+///
+/// With photon bundling (exampleB1 -b N) the scintillation yield is
+/// reduced by N and every scintillation photon is given the weight N
+/// here, so that each optical track stands for N photons. Photons
+/// re-emitted by the fiber inherit the weight of their parent.
+///
+/// It also starts every track in the StepProfiler when it is enabled.
+
+class TrackingAction : public G4UserTrackingAction
+{
+  public:
+    TrackingAction(G4int bundleFactor, StepProfiler* stepProfiler);
+    virtual ~TrackingAction();
+
+    virtual void PreUserTrackingAction(const G4Track*);
+
+  private:
+    G4int fBundleFactor;
+    StepProfiler* fStepProfiler;
+    G4ParticleDefinition* fOpticalPhoton;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
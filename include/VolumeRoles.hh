@@ -0,0 +1,93 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file VolumeRoles.hh
+/// \brief Definition of the VolumeRoles class
+
+#ifndef VolumeRoles_h
+#define VolumeRoles_h 1
+
+#include "G4LogicalVolume.hh"
+#include "G4VTouchable.hh"
+#include "globals.hh"
+
+#include <vector>
+
+/// Role of a logical volume in the detector.
+
+enum class VolumeRole : G4int
+{
+  kOther = 0,
+  kWorld,
+  kEnvelope,
+  kAbsorber,      // Fe yoke
+  kLayer,
+  kSupport,       // Al layer box
+  kStrip,
+  kSurface,       // scintillator skin carrying the reflective surface
+  kScintillator,  // BC420
+  kSlot,          // air cuts holding the fiber
+  kCladding,
+  kFiberCore,
+  kSiPM,
+  kNumRoles
+};
+
+/// Volume role table.
+///
+/// DetectorConstruction tags every logical volume it builds; the user
+/// actions and sensitive detectors then read the role with one lookup
+/// indexed by the logical volume instance ID instead of comparing names.
+/// The table is filled on the master before the run and only read
+/// by the workers.
+
+class VolumeRoles
+{
+  public:
+    static void Clear();
+    static void Set(const G4LogicalVolume* volume, VolumeRole role);
+
+    static VolumeRole Get(const G4LogicalVolume* volume);
+    static const char* GetName(VolumeRole role);
+
+    // depth of the first ancestor with the role, -1 if there is none
+    static G4int FindDepth(const G4VTouchable* touchable, VolumeRole role);
+
+  private:
+    static std::vector<VolumeRole> fRoles;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+inline VolumeRole VolumeRoles::Get(const G4LogicalVolume* volume)
+{
+  std::size_t id = volume->GetInstanceID();
+  return id < fRoles.size() ? fRoles[id] : VolumeRole::kOther;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,173 @@
+// Standalone geometry validation for the muon barrel.
+//
+//   muon_geocheck [-m macro] [-r resolution] [-t tolerance_mm]
+//                 [-j threads] [-s seed] [-o report.json]
+//
+// The barrel is constructed as in exampleB1 (the macro can select halves,
+// sectors and layers with the /muon/detector/ commands) and the overlap
+// check of every placement is run on a pool of threads. A placement
+// object is checked once: the strip templates are shared by all strips of
+// the same length, so their daughters are only tested in one mother.
+// Thread i seeds its random engine with seed + i, so the threads
+// sample different points.
+// A JSON report with the overlapping placements is written. The exit
+// code is 1 if any overlap was found and 3 if the report could not be
+// written.
+//
+// The production geometry does not check overlaps at construction time,
+// run this tool once after every geometry change instead.
+
+#include "DetectorConstruction.hh"
+
+#include "G4UImanager.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4PVPlacement.hh"
+#include "G4LogicalVolume.hh"
+#include "G4SolidStore.hh"
+#include "G4VSolid.hh"
+#include "G4Timer.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4UnitsTable.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+  void PrintUsage() {
+    G4cerr << " Usage: " << G4endl;
+    G4cerr << " muon_geocheck [-m macro] [-r resolution] [-t tolerance_mm]"
+           << " [-j threads] [-s seed] [-o report.json]" << G4endl;
+  }
+
+  struct Overlap {
+    G4String volume;
+    G4int copyNo;
+    G4String mother;
+  };
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc,char** argv)
+{
+  // Evaluate arguments
+  //
+  G4String macro;
+  G4String reportFile = "geocheck.json";
+  G4int resolution = 1000;
+  G4double tolerance = 0.;
+  G4int nThreads = std::max(1u, std::thread::hardware_concurrency());
+  long seed = 12345;
+  for ( G4int i = 1; i < argc; ++i ) {
+    G4String argument = argv[i];
+    if ( i + 1 >= argc ) {
+      PrintUsage();
+      return 2;
+    }
+    if ( argument == "-m" ) macro = argv[++i];
+    else if ( argument == "-r" ) resolution = std::atoi(argv[++i]);
+    else if ( argument == "-t" ) tolerance = std::atof(argv[++i]) * mm;
+    else if ( argument == "-j" ) nThreads = std::max(1, std::atoi(argv[++i]));
+    else if ( argument == "-s" ) seed = std::atol(argv[++i]);
+    else if ( argument == "-o" ) reportFile = argv[++i];
+    else {
+      PrintUsage();
+      return 2;
+    }
+  }
+
+  // Construct the geometry, the selections of the macro are applied first
+  //
+  DetectorConstruction detectorConstruction;
+  if ( ! macro.empty() ) {
+    G4UImanager::GetUIpointer()->ApplyCommand("/control/execute " + macro);
+  }
+  G4Timer timer;
+  detectorConstruction.Construct();
+
+  // Boolean solids fill their caches on the first surface point,
+  // do that here before the threads share them
+  for ( auto solid : *G4SolidStore::GetInstance() ) {
+    solid->GetPointOnSurface();
+  }
+
+  std::vector<G4PVPlacement*> placements;
+  for ( auto volume : *G4PhysicalVolumeStore::GetInstance() ) {
+    auto placement = dynamic_cast<G4PVPlacement*>(volume);
+    if ( placement ) placements.push_back(placement);
+  }
+
+  // Check the placements on the thread pool
+  //
+  G4cout << "Checking " << placements.size() << " placements with "
+         << resolution << " points and " << G4BestUnit(tolerance, "Length")
+         << " tolerance on " << nThreads << " threads" << G4endl;
+
+  timer.Start();
+  std::atomic<std::size_t> next(0);
+  std::mutex mutex;
+  std::vector<Overlap> overlaps;
+  std::vector<std::thread> threads;
+  for ( G4int i = 0; i < nThreads; ++i ) {
+    threads.emplace_back([&, i]() {
+      // each thread has its own engine, with the same default seed
+      G4Random::setTheSeed(seed + i);
+      for ( std::size_t j = next++; j < placements.size(); j = next++ ) {
+        auto placement = placements[j];
+        if ( placement->CheckOverlaps(resolution, tolerance, false) ) {
+          std::lock_guard<std::mutex> lock(mutex);
+          overlaps.push_back({ placement->GetName(), placement->GetCopyNo(),
+                               placement->GetMotherLogical()
+                               ? placement->GetMotherLogical()->GetName()
+                               : G4String("") });
+        }
+      }
+    });
+  }
+  for ( auto& thread : threads ) thread.join();
+  timer.Stop();
+
+  // Report
+  //
+  std::sort(overlaps.begin(), overlaps.end(),
+            [](const Overlap& a, const Overlap& b) {
+              return a.mother != b.mother ? a.mother < b.mother
+                   : a.volume != b.volume ? a.volume < b.volume
+                   : a.copyNo < b.copyNo;
+            });
+
+  std::ofstream report(reportFile);
+  report << "{\n"
+         << "  \"placements\": " << placements.size() << ",\n"
+         << "  \"resolution\": " << resolution << ",\n"
+         << "  \"tolerance_mm\": " << tolerance / mm << ",\n"
+         << "  \"threads\": " << nThreads << ",\n"
+         << "  \"seconds\": " << timer.GetRealElapsed() << ",\n"
+         << "  \"overlaps\": [";
+  for ( std::size_t i = 0; i < overlaps.size(); ++i ) {
+    report << ( i ? ",\n" : "\n" )
+           << "    { \"volume\": \"" << overlaps[i].volume
+           << "\", \"copy\": " << overlaps[i].copyNo
+           << ", \"mother\": \"" << overlaps[i].mother << "\" }";
+  }
+  report << ( overlaps.empty() ? "]\n" : "\n  ]\n" ) << "}\n";
+  report.close();
+  if ( ! report ) {
+    G4cerr << "Cannot write the report " << reportFile << G4endl;
+    return 3;
+  }
+
+  G4cout << overlaps.size() << " overlapping placements in "
+         << timer.GetRealElapsed() << " s, report written to "
+         << reportFile << G4endl;
+
+  return overlaps.empty() ? 0 : 1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,71 @@
+// Merge tool for the columnar event files written by exampleB1.
+//
+//   muon_merge output.mev input_t0.mev input_t1.mev ...
+//
+// The blocks of the inputs are copied unchanged one after the other and
+// a new block index is written, so the output can be read by event range
+// like any shard. Events keep the order of the inputs.
+
+#include "EventFormat.hh"
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc,char** argv)
+{
+  if ( argc < 3 ) {
+    std::cerr << "Usage: " << argv[0]
+              << " output.mev input1.mev [input2.mev ...]" << std::endl;
+    return 1;
+  }
+
+  std::FILE* output = std::fopen(argv[1], "wb");
+  if ( ! output ) {
+    std::cerr << "Cannot open " << argv[1] << std::endl;
+    return 1;
+  }
+
+  EventFormat::FileHeader header
+    = { EventFormat::kFileMagic, EventFormat::kVersion };
+  std::fwrite(&header, sizeof(header), 1, output);
+  std::uint64_t offset = sizeof(header);
+  std::uint64_t nEvents = 0;
+  std::uint64_t nHits = 0;
+  std::vector<EventFormat::BlockIndex> index;
+
+  std::vector<char> bytes;
+  for ( int i = 2; i < argc; ++i ) {
+    EventFormat::Reader reader;
+    if ( ! reader.Open(argv[i]) ) {
+      std::cerr << "Cannot read " << argv[i] << ", skipped" << std::endl;
+      continue;
+    }
+    for ( std::size_t block = 0; block < reader.GetIndex().size(); ++block ) {
+      const auto& entry = reader.GetIndex()[block];
+      if ( ! reader.ReadBlock(block, bytes) ) {
+        std::cerr << "Truncated block in " << argv[i] << std::endl;
+        break;
+      }
+      std::fwrite(bytes.data(), 1, bytes.size(), output);
+      index.push_back({ offset, nEvents, entry.nEvents, entry.nHits });
+      offset += bytes.size();
+      nEvents += entry.nEvents;
+      nHits += entry.nHits;
+    }
+  }
+
+  EventFormat::IndexTrailer trailer
+    = { offset, index.size(), EventFormat::kIndexMagic, 0 };
+  std::fwrite(index.data(), sizeof(EventFormat::BlockIndex), index.size(), output);
+  std::fwrite(&trailer, sizeof(trailer), 1, output);
+  std::fclose(output);
+
+  std::cout << argv[1] << ": " << nEvents << " events, " << nHits
+            << " hits in " << index.size() << " blocks" << std::endl;
+  return 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -3,11 +3,17 @@
 #include "RunAction.hh"
 #include "EventAction.hh"
 #include "SteppingAction.hh"
+#include "TrackingAction.hh"
+#include "StackingAction.hh"
+#include "StepProfiler.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-ActionInitialization::ActionInitialization()
- : G4VUserActionInitialization()
+ActionInitialization::ActionInitialization(G4int photonBundleFactor,
+                                           G4bool edepMode)
+ : G4VUserActionInitialization(),
+   fPhotonBundleFactor(photonBundleFactor),
+   fEdepMode(edepMode)
 {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -27,15 +33,22 @@ void ActionInitialization::BuildForMaster() const
 
 void ActionInitialization::Build() const
 {
-  SetUserAction(new PrimaryGeneratorAction);
-
   RunAction* runAction = new RunAction;
   SetUserAction(runAction);
+
+  SetUserAction(new PrimaryGeneratorAction(runAction));
   
   EventAction* eventAction = new EventAction(runAction);
   SetUserAction(eventAction);
   
-  SetUserAction(new SteppingAction(eventAction));
+  // one step profiler per thread, shared by the two actions
+  StepProfiler* stepProfiler = new StepProfiler;
+
+  SetUserAction(new SteppingAction(eventAction, stepProfiler, fEdepMode));
+
+  SetUserAction(new TrackingAction(fPhotonBundleFactor, stepProfiler));
+
+  SetUserAction(new StackingAction(eventAction, fPhotonBundleFactor));
 }  
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
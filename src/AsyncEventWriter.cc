@@ -0,0 +1,110 @@
+#include "AsyncEventWriter.hh"
+
+#include <chrono>
+#include <utility>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+AsyncEventWriter::AsyncEventWriter()
+: fQueue(nullptr),
+  fDone(false),
+  fMaxDepth(0),
+  fNStalls(0),
+  fStallTime(0.)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+AsyncEventWriter::~AsyncEventWriter()
+{
+  Close();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool AsyncEventWriter::Open(const std::string& fileName,
+                            std::size_t queueDepth, int compressionLevel)
+{
+  Close();
+  if ( ! fWriter.Open(fileName) ) return false;
+  fWriter.SetCompressionLevel(compressionLevel);
+
+  fQueue = new SpscQueue<EventRecord>(queueDepth);
+  fMaxDepth = 0;
+  fNStalls = 0;
+  fStallTime = 0.;
+  fDone = false;
+  fThread = std::thread(&AsyncEventWriter::Drain, this);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AsyncEventWriter::Close()
+{
+  if ( ! fThread.joinable() ) return;
+  fDone.store(true, std::memory_order_release);
+  fThread.join();
+  fWriter.Close();
+  delete fQueue;
+  fQueue = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::size_t AsyncEventWriter::GetQueueCapacity() const
+{
+  return fQueue ? fQueue->GetCapacity() : 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AsyncEventWriter::Push(EventRecord&& record)
+{
+  if ( ! fQueue->TryPush(std::move(record)) ) {
+    // the writer thread is behind: wait for a free slot
+    auto start = std::chrono::steady_clock::now();
+    do {
+      std::this_thread::yield();
+    } while ( ! fQueue->TryPush(std::move(record)) );
+    std::chrono::duration<double> stall
+      = std::chrono::steady_clock::now() - start;
+    fStallTime += stall.count();
+    ++fNStalls;
+  }
+  std::size_t depth = fQueue->GetSize();
+  if ( depth > fMaxDepth ) fMaxDepth = depth;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AsyncEventWriter::Drain()
+{
+  EventRecord record;
+  while ( true ) {
+    if ( fQueue->TryPop(record) ) {
+      Write(record);
+    }
+    else if ( fDone.load(std::memory_order_acquire) ) {
+      // the producer has stopped: write what is left and finish
+      while ( fQueue->TryPop(record) ) Write(record);
+      break;
+    }
+    else {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AsyncEventWriter::Write(const EventRecord& record)
+{
+  fWriter.BeginEvent(record.eventId);
+  for ( std::size_t i = 0; i < record.channel.size(); ++i ) {
+    fWriter.AddHit(record.channel[i], record.photoelectrons[i], record.time[i]);
+  }
+  fWriter.EndEvent();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
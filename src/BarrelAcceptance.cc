@@ -0,0 +1,127 @@
+#include "BarrelAcceptance.hh"
+#include "VolumeRoles.hh"
+
+#include "G4TransportationManager.hh"
+#include "G4Navigator.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VSolid.hh"
+#include "geomdefs.hh"
+
+#include <cmath>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+BarrelAcceptance::BarrelAcceptance()
+: fWorld(nullptr),
+  fRadius(0.),
+  fHalfLength(0.)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+BarrelAcceptance::~BarrelAcceptance()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BarrelAcceptance::Initialize(G4VPhysicalVolume* world)
+{
+  fAbsorbers.clear();
+  fRadius = fHalfLength = 0.;
+  fWorld = world;
+
+  G4LogicalVolume* logicWorld = world->GetLogicalVolume();
+
+  for ( std::size_t i = 0; i < logicWorld->GetNoDaughters(); ++i ) {
+    G4VPhysicalVolume* envelope = logicWorld->GetDaughter(i);
+    G4LogicalVolume* logicEnvelope = envelope->GetLogicalVolume();
+    if ( VolumeRoles::Get(logicEnvelope) != VolumeRole::kEnvelope ) continue;
+    G4AffineTransform envelopeToWorld(envelope->GetRotation(),
+                                      envelope->GetTranslation());
+
+    for ( std::size_t j = 0; j < logicEnvelope->GetNoDaughters(); ++j ) {
+      G4VPhysicalVolume* absorber = logicEnvelope->GetDaughter(j);
+      if ( VolumeRoles::Get(absorber->GetLogicalVolume())
+           != VolumeRole::kAbsorber ) continue;
+      G4AffineTransform toWorld
+        = G4AffineTransform(absorber->GetRotation(),
+                            absorber->GetTranslation()) * envelopeToWorld;
+      const G4VSolid* solid = absorber->GetLogicalVolume()->GetSolid();
+      fAbsorbers.push_back({ solid, toWorld.Inverse() });
+
+      // extend the bounding cylinder with the corners of the solid extent
+      G4ThreeVector pMin, pMax;
+      solid->BoundingLimits(pMin, pMax);
+      for ( G4int corner = 0; corner < 8; ++corner ) {
+        G4ThreeVector point(corner & 1 ? pMax.x() : pMin.x(),
+                            corner & 2 ? pMax.y() : pMin.y(),
+                            corner & 4 ? pMax.z() : pMin.z());
+        point = toWorld.TransformPoint(point);
+        fRadius = std::max(fRadius, point.perp());
+        fHalfLength = std::max(fHalfLength, std::abs(point.z()));
+      }
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool BarrelAcceptance::CrossesCylinder(const G4ThreeVector& position,
+                                         const G4ThreeVector& direction) const
+{
+  // parameter range of the line inside the infinite cylinder
+  G4double a = direction.x() * direction.x() + direction.y() * direction.y();
+  G4double b = position.x() * direction.x() + position.y() * direction.y();
+  G4double c = position.perp2() - fRadius * fRadius;
+  G4double tMin, tMax;
+  if ( a > 0. ) {
+    G4double discriminant = b * b - a * c;
+    if ( discriminant < 0. ) return false;
+    G4double root = std::sqrt(discriminant);
+    tMin = ( - b - root ) / a;
+    tMax = ( - b + root ) / a;
+  }
+  else {
+    if ( c > 0. ) return false;
+    tMin = - kInfinity;
+    tMax = kInfinity;
+  }
+
+  // intersect with the slab |z| < half length
+  if ( direction.z() != 0. ) {
+    G4double t1 = ( - fHalfLength - position.z() ) / direction.z();
+    G4double t2 = ( fHalfLength - position.z() ) / direction.z();
+    tMin = std::max(tMin, std::min(t1, t2));
+    tMax = std::min(tMax, std::max(t1, t2));
+  }
+  else if ( std::abs(position.z()) > fHalfLength ) {
+    return false;
+  }
+  return tMax >= std::max(tMin, 0.);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool BarrelAcceptance::Accept(const G4ThreeVector& position,
+                                const G4ThreeVector& direction)
+{
+  G4VPhysicalVolume* world
+    = G4TransportationManager::GetTransportationManager()
+        ->GetNavigatorForTracking()->GetWorldVolume();
+  if ( world != fWorld ) Initialize(world);
+  if ( ! CrossesCylinder(position, direction) ) return false;
+
+  for ( const auto& absorber : fAbsorbers ) {
+    G4ThreeVector localPosition
+      = absorber.worldToLocal.TransformPoint(position);
+    G4ThreeVector localDirection
+      = absorber.worldToLocal.TransformAxis(direction);
+    if ( absorber.solid->Inside(localPosition) != kOutside
+         || absorber.solid->DistanceToIn(localPosition, localDirection)
+            != kInfinity ) return true;
+  }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,266 @@
+#include "CalibrationScan.hh"
+#include "ChannelId.hh"
+#include "VolumeRoles.hh"
+#include "Run.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4RunManager.hh"
+#include "G4TransportationManager.hh"
+#include "G4Navigator.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Box.hh"
+#include "G4ParticleTable.hh"
+#include "G4SystemOfUnits.hh"
+
+#ifdef G4MULTITHREADED
+#include "G4MTRunManager.hh"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CalibrationScan* CalibrationScan::Instance()
+{
+  static CalibrationScan instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CalibrationScan::CalibrationScan()
+: fMessenger(nullptr),
+  fActive(false),
+  fNAlong(80),
+  fNAcross(4),
+  fEventsPerCell(100),
+  fFileName("light_response.bin"),
+  fParticleName("mu-"),
+  fEnergy(1024. * MeV),
+  fHalf(0),
+  fSector(0),
+  fLayer(0),
+  fOrientation(0),
+  fStrip(0),
+  fParticle(nullptr),
+  fStripHalfThickness(0.)
+{
+  fChannels[0] = fChannels[1] = 0;
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CalibrationScan::~CalibrationScan()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CalibrationScan::GetPrimary(G4int eventID,
+                                 G4ThreeVector& position,
+                                 G4ThreeVector& direction) const
+{
+  // start just above the strip and cross it perpendicularly
+  G4int cell = GetCell(eventID);
+  G4ThreeVector local(fMap.GetCellAcross(cell), fMap.GetCellAlong(cell),
+                      fStripHalfThickness + 0.1 * mm);
+  position = fStripToWorld.TransformPoint(local);
+  direction = fStripToWorld.TransformAxis(G4ThreeVector(0, 0, -1));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CalibrationScan::Start(G4int maxCells)
+{
+  fParticle = G4ParticleTable::GetParticleTable()->FindParticle(fParticleName);
+  if ( ! fParticle ) {
+    G4ExceptionDescription msg;
+    msg << "Unknown particle " << fParticleName << ", the scan is not run.";
+    G4Exception("CalibrationScan::Start()",
+      "MyCode0013", JustWarning, msg);
+    return;
+  }
+  if ( ! LocateStrip() ) return;
+
+  // resume from an existing map of the same grid and strip size
+  LightResponseMap previous;
+  if ( previous.Read(fFileName)
+       && previous.GetNAlong() == fNAlong && previous.GetNAcross() == fNAcross
+       && std::fabs(previous.GetHalfLength() - fMap.GetHalfLength()) < 0.1 * mm
+       && std::fabs(previous.GetHalfWidth() - fMap.GetHalfWidth()) < 0.1 * mm ) {
+    fMap = previous;
+  }
+
+  fPendingCells.clear();
+  for ( G4int cell = 0; cell < fMap.GetNCells(); ++cell ) {
+    if ( maxCells > 0 && G4int(fPendingCells.size()) == maxCells ) break;
+    if ( G4int(fMap.GetRecord(cell, 0).events) < fEventsPerCell ) {
+      fPendingCells.push_back(cell);
+    }
+  }
+  if ( fPendingCells.empty() ) {
+    G4cout << "Calibration scan: all " << fMap.GetNCells()
+           << " cells of " << fFileName << " are complete." << G4endl;
+    return;
+  }
+
+  G4cout << "Calibration scan: " << fPendingCells.size() << " cells x "
+         << fEventsPerCell << " events into " << fFileName << G4endl;
+
+  auto runManager = G4RunManager::GetRunManager();
+#ifdef G4MULTITHREADED
+  auto mtRunManager = dynamic_cast<G4MTRunManager*>(runManager);
+  G4int eventModulo = mtRunManager ? mtRunManager->GetEventModulo() : 1;
+  if ( mtRunManager ) mtRunManager->SetEventModulo(fEventsPerCell);
+#endif
+  fActive = true;
+  runManager->BeamOn(G4int(fPendingCells.size()) * fEventsPerCell);
+  fActive = false;
+#ifdef G4MULTITHREADED
+  if ( mtRunManager ) mtRunManager->SetEventModulo(eventModulo);
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool CalibrationScan::LocateStrip()
+{
+  // follow the copy numbers from the world down to the selected strip
+  G4VPhysicalVolume* volume
+    = G4TransportationManager::GetTransportationManager()
+        ->GetNavigatorForTracking()->GetWorldVolume();
+  const struct { VolumeRole role; G4int copyNo; } path[] = {
+    { VolumeRole::kEnvelope, ChannelId::EnvelopeCopyNo(fHalf, fSector) },
+    { VolumeRole::kAbsorber, 0 },
+    { VolumeRole::kLayer, fLayer },
+    { VolumeRole::kSupport, 0 },
+    { VolumeRole::kStrip, ChannelId::StripCopyNo(fOrientation, fStrip) }
+  };
+
+  G4AffineTransform toWorld;
+  for ( const auto& step : path ) {
+    G4LogicalVolume* mother = volume->GetLogicalVolume();
+    volume = nullptr;
+    for ( std::size_t i = 0; i < mother->GetNoDaughters(); ++i ) {
+      G4VPhysicalVolume* daughter = mother->GetDaughter(i);
+      if ( daughter->GetCopyNo() == step.copyNo
+           && VolumeRoles::Get(daughter->GetLogicalVolume()) == step.role ) {
+        volume = daughter;
+        break;
+      }
+    }
+    if ( ! volume ) {
+      G4ExceptionDescription msg;
+      msg << "Strip (half " << fHalf << ", sector " << fSector
+          << ", layer " << fLayer << ", orientation " << fOrientation
+          << ", strip " << fStrip << ") is not in the geometry.";
+      G4Exception("CalibrationScan::LocateStrip()",
+        "MyCode0002", JustWarning, msg);
+      return false;
+    }
+    toWorld = G4AffineTransform(volume->GetRotation(),
+                                volume->GetTranslation()) * toWorld;
+  }
+  fStripToWorld = toWorld;
+
+  auto solid = static_cast<const G4Box*>(volume->GetLogicalVolume()->GetSolid());
+  fStripHalfThickness = solid->GetZHalfLength();
+  fMap.SetGrid(fNAlong, fNAcross, solid->GetYHalfLength(), solid->GetXHalfLength());
+
+  auto stripId = ChannelId::Pack(fHalf, fSector, fLayer, fOrientation, fStrip, 0);
+  fChannels[0] = ChannelId::ToIndex(stripId);
+  fChannels[1] = ChannelId::ToIndex(ChannelId::GetOtherEnd(stripId));
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CalibrationScan::EndOfRun(const Run* run)
+{
+  const auto& sums = run->GetCalibrationSums();
+  for ( auto cell : fPendingCells ) {
+    const Run::CellSums& cellSums = sums[cell];
+    if ( cellSums.events <= 0. ) continue;
+    for ( G4int end = 0; end < 2; ++end ) {
+      LightResponseMap::Record& record = fMap.GetRecord(cell, end);
+      G4double n = cellSums.events;
+      G4double meanPe = cellSums.pe[end] / n;
+      record.events = std::uint32_t(n);
+      record.meanPe = meanPe;
+      record.varPe = std::max(cellSums.pe2[end] / n - meanPe * meanPe, 0.);
+      record.meanEdep = cellSums.visibleEdep / n;
+      G4double nt = cellSums.timeEntries[end];
+      G4double meanTime = nt > 0. ? cellSums.time[end] / nt : 0.;
+      record.meanTime = meanTime;
+      record.rmsTime = nt > 0.
+        ? std::sqrt(std::max(cellSums.time2[end] / nt - meanTime * meanTime, 0.))
+        : 0.;
+    }
+  }
+
+  if ( fMap.Write(fFileName) ) {
+    G4cout << "Calibration scan: light response map written to "
+           << fFileName << G4endl;
+  }
+  else {
+    G4ExceptionDescription msg;
+    msg << "Cannot write the light response map " << fFileName;
+    G4Exception("CalibrationScan::EndOfRun()",
+      "MyCode0003", JustWarning, msg);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CalibrationScan::SetStrip(G4String value)
+{
+  std::istringstream is(value);
+  is >> fHalf >> fSector >> fLayer >> fOrientation >> fStrip;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CalibrationScan::DefineCommands()
+{
+  // Define /muon/calibration command directory using generic messenger class
+  fMessenger = new G4GenericMessenger(this,
+                                      "/muon/calibration/",
+                                      "Strip light response calibration");
+
+  fMessenger->DeclareProperty("nAlong", fNAlong,
+    "Number of grid cells along the strip.");
+  fMessenger->DeclareProperty("nAcross", fNAcross,
+    "Number of grid cells across the strip.");
+  fMessenger->DeclareProperty("eventsPerCell", fEventsPerCell,
+    "Number of muons fired in each grid cell.");
+  fMessenger->DeclareProperty("fileName", fFileName,
+    "Light response map written by the scan.");
+  fMessenger->DeclareProperty("particle", fParticleName,
+    "Particle fired by the scan.");
+
+  auto& energyCmd
+    = fMessenger->DeclarePropertyWithUnit("energy", "MeV", fEnergy,
+        "Kinetic energy of the particle fired by the scan.");
+  energyCmd.SetParameterName("energy", false);
+  energyCmd.SetRange("energy>0.");
+
+  auto& stripCmd
+    = fMessenger->DeclareMethod("strip", &CalibrationScan::SetStrip,
+        "Select the scanned strip: half sector layer orientation strip.");
+  stripCmd.SetParameterName("strip", false);
+
+  auto& runCmd
+    = fMessenger->DeclareMethod("run", &CalibrationScan::Start,
+        "Run the scan on the pending cells (at most maxCells, 0 = all).");
+  runCmd.SetParameterName("maxCells", true);
+  runCmd.SetDefaultValue("0");
+  runCmd.SetStates(G4State_Idle);
+  runCmd.command->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,245 @@
+#include "CosmicMuonGenerator.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4MuonPlus.hh"
+#include "G4MuonMinus.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4UnitsTable.hh"
+#include "G4Threading.hh"
+#include "Randomize.hh"
+
+#include <cmath>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CosmicMuonGenerator::CosmicMuonGenerator()
+: fMessenger(nullptr),
+  fMuPlus(G4MuonPlus::Definition()),
+  fMuMinus(G4MuonMinus::Definition()),
+  fSphere(false),
+  fMinEnergy(0.5 * GeV),
+  fMaxEnergy(10. * TeV),
+  fMaxZenith(85. * deg),
+  fPlaneHeight(15. * m),
+  fPlaneHalfSize(15. * m),
+  fSphereRadius(13. * m),
+  fChargeRatio(1.28),
+  fNCosBins(100),
+  fNEnergyBins(200),
+  fValid(false),
+  fCosMin(0.),
+  fLogEMin(0.),
+  fLogEStep(0.),
+  fRate(0.)
+{
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CosmicMuonGenerator::~CosmicMuonGenerator()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double CosmicMuonGenerator::Flux(G4double energy, G4double cosTheta)
+{
+  // Guan et al., modified Gaisser formula; energy in GeV
+  const G4double p1 = 0.102573, p2 = -0.068287, p3 = 0.958633,
+                 p4 = 0.0407253, p5 = 0.817285;
+  G4double cosStar2
+    = ( cosTheta * cosTheta + p1 * p1 + p2 * std::pow(cosTheta, p3)
+        + p4 * std::pow(cosTheta, p5) ) / ( 1. + p1 * p1 + p2 + p4 );
+  G4double cosStar = std::sqrt(std::max(cosStar2, 0.));
+
+  G4double e = energy * ( 1. + 3.64 / ( energy * std::pow(cosStar, 1.29) ) );
+  return 0.14 * std::pow(e, -2.7)
+       * ( 1. / ( 1. + 1.1 * energy * cosStar / 115. )
+         + 0.054 / ( 1. + 1.1 * energy * cosStar / 850. ) );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CosmicMuonGenerator::BuildTables()
+{
+  const G4double mass = fMuMinus->GetPDGMass();
+  G4double eMin = ( fMinEnergy + mass ) / GeV;
+  G4double eMax = ( fMaxEnergy + mass ) / GeV;
+  fCosMin = std::cos(fMaxZenith);
+  fLogEMin = std::log(eMin);
+  fLogEStep = ( std::log(eMax) - fLogEMin ) / fNEnergyBins;
+  G4double cosStep = ( 1. - fCosMin ) / fNCosBins;
+
+  // rate of each cell through the generation surface
+  G4int nCells = fNCosBins * fNEnergyBins;
+  std::vector<G4double> weight(nCells);
+  G4double total = 0.;
+  for ( G4int i = 0; i < fNCosBins; ++i ) {
+    G4double cosTheta = fCosMin + ( i + 0.5 ) * cosStep;
+    G4double acceptance = fSphere ? 1. : cosTheta;
+    for ( G4int j = 0; j < fNEnergyBins; ++j ) {
+      G4double low = std::exp(fLogEMin + j * fLogEStep);
+      G4double high = std::exp(fLogEMin + ( j + 1 ) * fLogEStep);
+      G4double energy = std::sqrt(low * high);
+      G4double w = Flux(energy, cosTheta) * ( high - low ) * cosStep
+                 * acceptance;
+      weight[i * fNEnergyBins + j] = w;
+      total += w;
+    }
+  }
+
+  // Walker alias table (Vose's construction)
+  fAliasProbability.assign(nCells, 1.);
+  fAlias.resize(nCells);
+  std::vector<G4int> small, large;
+  for ( G4int k = 0; k < nCells; ++k ) {
+    weight[k] *= nCells / total;
+    fAlias[k] = k;
+    ( weight[k] < 1. ? small : large ).push_back(k);
+  }
+  while ( ! small.empty() && ! large.empty() ) {
+    G4int s = small.back(); small.pop_back();
+    G4int l = large.back();
+    fAliasProbability[s] = weight[s];
+    fAlias[s] = l;
+    weight[l] -= 1. - weight[s];
+    if ( weight[l] < 1. ) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+
+  // total rate: flux integral times 2 pi in azimuth times surface
+  G4double area = fSphere ? pi * fSphereRadius * fSphereRadius
+                          : 4. * fPlaneHalfSize * fPlaneHalfSize;
+  fRate = total * twopi * area / cm2;
+  fValid = true;
+
+  if ( G4Threading::G4GetThreadId() > 0 ) return;
+  G4cout << G4endl
+         << "--------------------Cosmic muon generator--------------------"
+         << G4endl
+         << " " << ( fSphere ? "sphere" : "plane" ) << " source, "
+         << G4BestUnit(fMinEnergy, "Energy") << " - "
+         << G4BestUnit(fMaxEnergy, "Energy") << ", zenith < "
+         << fMaxZenith / deg << " deg, "
+         << fNCosBins << " x " << fNEnergyBins << " cells" << G4endl
+         << " Rate through the generation surface: " << fRate << " Hz" << G4endl
+         << "-------------------------------------------------------------"
+         << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double CosmicMuonGenerator::GetRate()
+{
+  if ( ! fValid ) BuildTables();
+  return fRate;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CosmicMuonGenerator::Generate(G4ParticleDefinition*& particle,
+                                   G4double& kineticEnergy,
+                                   G4ThreeVector& position,
+                                   G4ThreeVector& direction)
+{
+  if ( ! fValid ) BuildTables();
+
+  // alias lookup
+  G4double u = G4UniformRand() * fAliasProbability.size();
+  G4int cell = std::min(G4int(u), G4int(fAliasProbability.size()) - 1);
+  if ( u - cell >= fAliasProbability[cell] ) cell = fAlias[cell];
+
+  G4int i = cell / fNEnergyBins;
+  G4int j = cell % fNEnergyBins;
+  G4double cosStep = ( 1. - fCosMin ) / fNCosBins;
+  G4double cosTheta = fCosMin + ( i + G4UniformRand() ) * cosStep;
+  G4double energy
+    = std::exp(fLogEMin + ( j + G4UniformRand() ) * fLogEStep) * GeV;
+
+  particle = G4UniformRand() < fChargeRatio / ( 1. + fChargeRatio )
+           ? fMuPlus : fMuMinus;
+  kineticEnergy = energy - particle->GetPDGMass();
+
+  // downward going, +y is up
+  G4double sinTheta = std::sqrt(1. - cosTheta * cosTheta);
+  G4double phi = twopi * G4UniformRand();
+  direction.set(sinTheta * std::cos(phi), -cosTheta, sinTheta * std::sin(phi));
+
+  if ( fSphere ) {
+    // uniform on the disk through the centre perpendicular to the
+    // direction, moved back onto the sphere
+    G4double r = fSphereRadius * std::sqrt(G4UniformRand());
+    G4double psi = twopi * G4UniformRand();
+    G4ThreeVector e1 = direction.orthogonal().unit();
+    G4ThreeVector e2 = direction.cross(e1);
+    position = r * ( std::cos(psi) * e1 + std::sin(psi) * e2 )
+             - fSphereRadius * direction;
+  }
+  else {
+    position.set(fPlaneHalfSize * ( 2. * G4UniformRand() - 1. ), fPlaneHeight,
+                 fPlaneHalfSize * ( 2. * G4UniformRand() - 1. ));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CosmicMuonGenerator::SetSurface(G4String surface)
+{
+  fSphere = ( surface == "sphere" );
+  fValid = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CosmicMuonGenerator::DefineCommands()
+{
+  // Define /muon/gun/cosmic command directory using generic messenger class
+  fMessenger
+    = new G4GenericMessenger(this, "/muon/gun/cosmic/", "Cosmic muon source");
+
+  auto& surfaceCmd
+    = fMessenger->DeclareMethod("surface", &CosmicMuonGenerator::SetSurface,
+        "Generation surface: horizontal plane above the barrel or sphere.");
+  surfaceCmd.SetParameterName("surface", false);
+  surfaceCmd.SetCandidates("plane sphere");
+
+  auto& minECmd
+    = fMessenger->DeclareMethodWithUnit("minEnergy", "GeV",
+        &CosmicMuonGenerator::SetMinEnergy, "Minimum kinetic energy.");
+  minECmd.SetParameterName("minEnergy", false);
+  minECmd.SetRange("minEnergy>0.");
+
+  auto& maxECmd
+    = fMessenger->DeclareMethodWithUnit("maxEnergy", "GeV",
+        &CosmicMuonGenerator::SetMaxEnergy, "Maximum kinetic energy.");
+  maxECmd.SetParameterName("maxEnergy", false);
+  maxECmd.SetRange("maxEnergy>0.");
+
+  auto& zenithCmd
+    = fMessenger->DeclareMethodWithUnit("maxZenith", "deg",
+        &CosmicMuonGenerator::SetMaxZenith, "Maximum zenith angle.");
+  zenithCmd.SetParameterName("maxZenith", false);
+  zenithCmd.SetRange("maxZenith>0. && maxZenith<=90.");
+
+  fMessenger->DeclareMethodWithUnit("planeHeight", "m",
+    &CosmicMuonGenerator::SetPlaneHeight, "Height of the generation plane.");
+  fMessenger->DeclareMethodWithUnit("planeHalfSize", "m",
+    &CosmicMuonGenerator::SetPlaneHalfSize,
+    "Half size in x and z of the generation plane.");
+  fMessenger->DeclareMethodWithUnit("sphereRadius", "m",
+    &CosmicMuonGenerator::SetSphereRadius,
+    "Radius of the generation sphere around the barrel.");
+
+  auto& ratioCmd
+    = fMessenger->DeclareProperty("chargeRatio", fChargeRatio,
+        "Ratio of the mu+ to mu- flux.");
+  ratioCmd.SetParameterName("chargeRatio", false);
+  ratioCmd.SetRange("chargeRatio>=0.");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,104 @@
+#include "DeferredStripLight.hh"
+#include "ChannelId.hh"
+#include "SiPMSD.hh"
+#include "TaskPool.hh"
+
+#include "G4Poisson.hh"
+
+#include <limits>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DeferredStripLight::DeferredStripLight()
+: fStripSlots(ChannelId::kNumStrips, -1)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DeferredStripLight::~DeferredStripLight()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DeferredStripLight::AddPhoton(std::uint32_t stripId, G4double halfLength,
+                                   const G4ThreeVector& localPosition,
+                                   G4double time, G4double weight)
+{
+  G4int& slot = fStripSlots[ChannelId::ToStripIndex(stripId)];
+  if ( slot < 0 ) {
+    slot = fStrips.size();
+    fStrips.emplace_back();
+    fStrips.back().stripId = stripId;
+    fStrips.back().halfLength = halfLength;
+  }
+  fStrips[slot].photons.push_back({ float(localPosition.x()),
+                                    float(localPosition.y()),
+                                    float(weight), time });
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DeferredStripLight::Evaluate(Strip& strip,
+                                  const LightResponseMap* responseMap,
+                                  G4double photonsPerMeV) const
+{
+  for ( G4int end = 0; end < ChannelId::kEnds; ++end ) {
+    G4double meanPe = 0.;
+    G4double firstTime = std::numeric_limits<G4double>::max();
+    const LightResponseMap::Record* firstRecord = nullptr;
+    for ( const auto& photon : strip.photons ) {
+      G4double distance = end == 0 ? strip.halfLength + photon.y
+                                   : strip.halfLength - photon.y;
+      const auto& record = responseMap->Find(end, distance, photon.x);
+      if ( record.meanPe <= 0. || record.meanEdep <= 0. ) continue;
+      // detected per emitted photon, from the calibrated pe per MeV
+      meanPe += photon.weight * record.meanPe / record.meanEdep
+                / photonsPerMeV;
+      if ( photon.time < firstTime ) {
+        firstTime = photon.time;
+        firstRecord = &record;
+      }
+    }
+    strip.meanPe[end] = meanPe;
+    strip.firstTime[end] = firstTime;
+    strip.firstRecord[end] = firstRecord;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DeferredStripLight::Process(const LightResponseMap* responseMap,
+                                 SiPMSD* sipmSD, G4double photonsPerMeV,
+                                 G4int nThreads)
+{
+  // one task per strip on the shared pool, this thread takes part
+  auto pool = TaskPool::Instance();
+  pool->Reserve(nThreads);
+  pool->Run(fStrips.size(), [&](std::size_t i) {
+    Evaluate(fStrips[i], responseMap, photonsPerMeV);
+  });
+
+  // sampling on the event thread, in strip order
+  for ( const auto& strip : fStrips ) {
+    for ( G4int end = 0; end < ChannelId::kEnds; ++end ) {
+      if ( ! strip.firstRecord[end] ) continue;
+      G4int npe = G4int(G4Poisson(strip.meanPe[end]));
+      if ( npe == 0 ) continue;
+      sipmSD->AddPhotoelectrons(ChannelId::ToIndex(strip.stripId | end), npe,
+        strip.firstTime[end]
+        + responseMap->SampleArrivalTime(*strip.firstRecord[end]));
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DeferredStripLight::Clear()
+{
+  for ( const auto& strip : fStrips ) {
+    fStripSlots[ChannelId::ToStripIndex(strip.stripId)] = -1;
+  }
+  fStrips.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
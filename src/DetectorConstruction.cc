@@ -1,10 +1,33 @@
 #include "DetectorConstruction.hh"
+#include "VolumeRoles.hh"
+#include "SiPMSD.hh"
+#include "ChannelId.hh"
+#include "LightResponseMap.hh"
+#include "StripLightModel.hh"
+#include "StartupProfiler.hh"
+#include "ParameterHash.hh"
 
 #include "G4RunManager.hh"
+#include "G4StateManager.hh"
+#include "G4GeometryManager.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4SolidStore.hh"
+#include "G4Timer.hh"
+
+#ifdef G4LIB_USE_GDML
+#include "G4GDMLParser.hh"
+#endif
+#include "G4SDManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
 
 #include "G4Material.hh"
 #include "G4Element.hh"
 #include "G4MaterialTable.hh"
+#include "G4MaterialPropertiesTable.hh"
 
 #include "G4NistManager.hh"
 
@@ -28,20 +51,80 @@
 
 #include "math.h"
 #include "G4VisAttributes.hh"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+namespace
+{
+  // bump when the volumes or placements of Construct() change, to
+  // invalidate caches; materials and optical surfaces are hashed
+  const G4int kGeometryVersion = 1;
+
+  // property vectors and constants of a table, for the cache key
+  void AppendProperties(std::ostream& key,
+                        const G4MaterialPropertiesTable* table)
+  {
+    if ( ! table ) return;
+    for ( const auto& property : *table->GetPropertyMap() ) {
+      key << " " << property.first;
+      const G4MaterialPropertyVector* vector = property.second;
+      if ( ! vector ) continue;
+      for ( std::size_t i = 0; i < vector->GetVectorLength(); ++i ) {
+        key << " " << vector->Energy(i) << " " << (*vector)[i];
+      }
+    }
+    for ( const auto& property : *table->GetConstPropertyMap() ) {
+      key << " " << property.first << " " << property.second;
+    }
+  }
+}
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreadLocal StripLightModel* DetectorConstruction::fStripLightModel = nullptr;
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 DetectorConstruction::DetectorConstruction()
-: G4VUserDetectorConstruction()
+: G4VUserDetectorConstruction(),
+  fCheckOverlaps(false),
+  fHalfMask((1 << ChannelId::kHalves) - 1),
+  fSectorMask((1 << ChannelId::kSectors) - 1),
+  fLayerMask((1 << ChannelId::kLayers) - 1),
+  fPhotonBundleFactor(1),
+  fStripRotation(nullptr),
+  fFiberRotation(nullptr),
+  fSolidSiPM(nullptr),
+  fMessenger(nullptr),
+  fStripRegion(nullptr),
+  fAbsorberRegion(nullptr),
+  fSupportRegion(nullptr),
+  fAbsorberCut(5. * mm),
+  fSupportCut(1. * mm),
+  fStripCut(0.7 * mm),
+  fFastLightModel(false),
+  fLightResponseMap(new LightResponseMap),
+  fShareStripTemplates(true),
+  fVerboseLevel(1)
 { 
   fBC420 = fAir = fSiPM = fsurface = fPMMA = fPethylene1 = fFe = fAl = nullptr;
   fN = fO = fC = fH = nullptr;
+  fSurfaceOptical = fCladdingOptical = nullptr;
   DefineMaterials();
+  DefineOpticalSurfaces();
+  StartupProfiler::Instance()->EndPhase("materials");
+  DefineCommands();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 DetectorConstruction::~DetectorConstruction()
-{ }
+{
+  delete fMessenger;
+  delete fLightResponseMap;
+}
 
 // define the materials
 void DetectorConstruction::DefineMaterials()
@@ -156,9 +239,83 @@ void DetectorConstruction::DefineMaterials()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+// define one optical surface per surface type; they are shared by every
+// strip template instead of being created for each strip
+void DetectorConstruction::DefineOpticalSurfaces()
+{
+    G4double sur_Energy[] = { 2.38 * eV, 2.88 * eV, 3.45 * eV };
+    const G4int num = sizeof(sur_Energy) / sizeof(G4double);
+
+    fSurfaceOptical = new G4OpticalSurface("Surface");
+    fSurfaceOptical->SetType(dielectric_metal);
+    fSurfaceOptical->SetFinish(polished);
+    fSurfaceOptical->SetModel(glisur);
+    G4double sur_RefractionIndex[] = { 1.58, 1.58, 1.58 };
+    assert(sizeof(sur_RefractionIndex) == sizeof(sur_Energy));
+    G4MaterialPropertiesTable* SURMPT = new G4MaterialPropertiesTable();
+    SURMPT->AddProperty("RINDEX", sur_Energy, sur_RefractionIndex,num);
+    fSurfaceOptical->SetMaterialPropertiesTable(SURMPT);
+
+    fCladdingOptical = new G4OpticalSurface("Cladding");
+    fCladdingOptical->SetType(dielectric_metal);
+    fCladdingOptical->SetFinish(polished);
+    fCladdingOptical->SetModel(glisur);
+    G4double cladding_RefractionIndex[] = { 1.49, 1.49, 1.49 };
+    assert(sizeof(cladding_RefractionIndex) == sizeof(sur_Energy));
+    G4MaterialPropertiesTable* CLAMPT = new G4MaterialPropertiesTable();
+    CLAMPT->AddProperty("RINDEX", sur_Energy, cladding_RefractionIndex,num);
+    fCladdingOptical->SetMaterialPropertiesTable(CLAMPT);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 G4VPhysicalVolume* DetectorConstruction::Construct()
+{
+  G4Timer timer;
+  timer.Start();
+
+  CleanGeometry();
+  fSolidSiPM = new G4Box("SiPM", 3 * mm, 0.005 * cm, 3 * mm);
+
+  // strips are the roots of their own region, used by the fast light model;
+  // the passive Fe and Al get coarser production cuts
+  fStripRegion = CreateRegion("StripRegion", fStripCut);
+  fAbsorberRegion = CreateRegion("FeAbsorberRegion", fAbsorberCut);
+  fSupportRegion = CreateRegion("AlSupportRegion", fSupportCut);
+
+  if ( ! fLightResponseFile.empty()
+       && ! fLightResponseMap->Read(fLightResponseFile) ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot read the light response map " << fLightResponseFile
+        << ", the analytic response is used.";
+    G4Exception("DetectorConstruction::Construct()",
+      "MyCode0001", JustWarning, msg);
+  }
+
+  // the geometry cache replaces the construction when it has the same key
+  G4String cacheFile = GetGeometryCacheFile();
+  G4VPhysicalVolume* world = nullptr;
+  if ( ! cacheFile.empty() ) world = ReadGeometryCache(cacheFile);
+  G4bool fromCache = ( world != nullptr );
+  if ( ! fromCache ) {
+    world = ConstructBarrel();
+    if ( ! cacheFile.empty() ) WriteGeometryCache(world, cacheFile);
+  }
+
+  timer.Stop();
+  if ( fVerboseLevel > 0 ) {
+    G4cout << "Geometry " << ( fromCache ? "loaded from " + cacheFile : "built" )
+           << " in " << timer.GetRealElapsed() << " s" << G4endl;
+  }
+  StartupProfiler::Instance()->EndPhase("geometry");
+
+  return world;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4VPhysicalVolume* DetectorConstruction::ConstructBarrel()
 {  
-  G4bool checkOverlaps = true;    //check for overlaps
   G4int strip_num[12] = { 30, 100, 40, 100, 55, 100, 70, 100, 80, 100, 95, 100};    //the number of stripes in each layer
   G4RotationMatrix* rm_Fe = new G4RotationMatrix;
   rm_Fe->rotateX(90 * deg);
@@ -166,15 +323,26 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
   G4double x_b = x_a + 210 * sqrt(3) * cm;
   G4VisAttributes* blank = new G4VisAttributes(false);
 
+  // rotations shared by every strip placement and every strip template
+  fStripRotation = new G4RotationMatrix;
+  fStripRotation->rotateZ(90 * deg);
+  fFiberRotation = new G4RotationMatrix;
+  fFiberRotation->rotateX(90 * deg);
+
   auto solidworld = new G4Box( "World", 20 * m , 20 * m , 20 * m );
   auto logicworld = new G4LogicalVolume( solidworld, fAir, "World" );
-  auto physworld = new G4PVPlacement( nullptr, G4ThreeVector(), logicworld, "World", 0, false, 0, checkOverlaps);
+  auto physworld = new G4PVPlacement( nullptr, G4ThreeVector(), logicworld, "World", 0, false, 0, fCheckOverlaps);
   logicworld->SetVisAttributes(blank);
+  VolumeRoles::Set(logicworld, VolumeRole::kWorld);
   //Fe frame
+  G4int nofModules = 0;
   for ( G4int i5 = 0; i5 < 2; i5 ++)
   {
+    if ( ! ( fHalfMask & ( 1 << i5 ) ) ) continue;
     for ( G4int i4 = 0; i4 < 12; i4 ++ )
     {
+      if ( ! ( fSectorMask & ( 1 << i4 ) ) ) continue;
+      ++nofModules;
       G4RotationMatrix* rm_env = new G4RotationMatrix;
       rm_env->rotateZ( i4 * 30 * deg);
       G4double env_sizeX = 210 * ( 1 + sqrt(3) ) * cm;
@@ -182,20 +350,22 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
       G4double env_posZ = 202.5 * ( 2 * i5 - 1 ) * cm;
       auto solidenv = new G4Box( "Envelope", env_sizeX , env_sizeY , 202.5 * cm );
       auto logicenv = new G4LogicalVolume( solidenv, fAir, "Envelope" );
-      auto physenv = new G4PVPlacement( rm_env, G4ThreeVector(0,0,env_posZ), logicenv, "Envelope", logicworld, false, i4, checkOverlaps);
+      new G4PVPlacement( rm_env, G4ThreeVector(0,0,env_posZ), logicenv, "Envelope", logicworld, false, ChannelId::EnvelopeCopyNo(i5, i4), fCheckOverlaps);
       logicenv->SetVisAttributes(blank);
+      VolumeRoles::Set(logicenv, VolumeRole::kEnvelope);
 
       G4double Fe_posX = -1 * 105 * cm;
       G4double Fe_posY = -1 * 105 * ( 2.5 + 1.5 * sqrt(3) ) * cm;
       auto solidFe = new G4Trd( "Fe",  0.5 * x_a, 0.5 * x_b, 202.5 * cm, 202.5 * cm, 52.5 * cm);
       auto logicFe = new G4LogicalVolume( solidFe, fFe, "Fe" );
-      auto physFe = new G4PVPlacement( rm_Fe, G4ThreeVector( Fe_posX, Fe_posY, 0 ), logicFe, "Fe", logicenv, false, i4, checkOverlaps);
-
-      G4Box* solidSiPM = new G4Box("SiPM", 3 * mm, 0.005 * cm, 3 * mm);
+      VolumeRoles::Set(logicFe, VolumeRole::kAbsorber);
+      fAbsorberRegion->AddRootLogicalVolume(logicFe);
+      new G4PVPlacement( rm_Fe, G4ThreeVector( Fe_posX, Fe_posY, 0 ), logicFe, "Fe", logicenv, false, 0, fCheckOverlaps);
 
       //place the scintillator
       for ( G4int i1 = 0; i1 < 6; i1 ++ )
       {
+        if ( ! ( fLayerMask & ( 1 << i1 ) ) ) continue;
         G4int i7 = 2 * i1;
         G4double layer_sizeX =  ( 4 * strip_num[i7] + 0.2 ) * cm;
         G4double layer_posy = ( 1 - 2 * i5 ) * 2.4 * cm;
@@ -212,7 +382,8 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
                                 logicFe,
                                 false,
                                 i1,
-                                checkOverlaps);
+                                fCheckOverlaps);
+        VolumeRoles::Set(logiclayer, VolumeRole::kLayer);
         
         G4double Al_sizeX = ( 4 * strip_num[i7] + 0.1 ) * cm;
         auto solidAl = new G4Box("Al", 0.5 * Al_sizeX, 200.05 * cm, 2.05 * cm);
@@ -226,205 +397,62 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
                                 "Al",
                                 logiclayer,
                                 false,
-                                i1,
-                                checkOverlaps);
+                                0,
+                                fCheckOverlaps);
+        VolumeRoles::Set(logicAl, VolumeRole::kSupport);
+        fSupportRegion->AddRootLogicalVolume(logicAl);
         for ( G4int i6 = 0; i6 < 2; i6 ++ )
         {
           G4int i3 = 2 * i1 + i6;
+          //horizontal and vertical alternate arrangement
+          G4RotationMatrix* rm = nullptr;
+          G4double strip_sizeY = 200 * cm;
+          if( i6 == 1 )
+          {
+            rm = fStripRotation;
+            strip_sizeY = 2 * strip_num[i7] * cm;
+          }
+          // every strip of this half-layer is the same template
+          G4LogicalVolume* logicstrip = GetStripTemplate(strip_sizeY);
           for( G4int i2 = 0; i2 < strip_num[i3]; i2 ++ )
           {
-            G4RotationMatrix* rm = new G4RotationMatrix;
-            G4RotationMatrix* rm_fiber = new G4RotationMatrix;
-            G4RotationMatrix* rm_cut3 = new G4RotationMatrix;
-            rm_fiber->rotateX( 90 * deg);
-            rm_cut3->rotateX( 90 * deg);
             G4double strip_posX;
             G4double strip_posY;
             G4double strip_posZ;
-            G4double strip_sizeY;
-            //horizontal and vertical alternate arrangement
             if( i6 == 1 )
             {
-              rm->rotateZ(90 * deg);
-              strip_sizeY = 2 * strip_num[i7] * cm;
               strip_posX = 0;
               strip_posY = ( 4 * i2 - 198 ) * cm;
               strip_posZ = 0.5 * cm;
             }
             else
             {
-              strip_sizeY = 200 * cm;
               strip_posX = ( 2 + 4 * i2 - 2 * strip_num[i3] ) * cm;
               strip_posY = 0;
               strip_posZ = -0.5 * cm;
             } 
-            G4double surface_sizeY = strip_sizeY;
-            G4double BC420_sizeY = strip_sizeY - 0.01 * cm;
-            G4double cut1_sizeY = BC420_sizeY;
-            G4double cut2_sizeY = BC420_sizeY;
-            G4double cut3_sizeZ = BC420_sizeY;
-            G4double Cladding_sizeZ = BC420_sizeY;
-            G4double Core_sizeZ = BC420_sizeY;
-            G4double SiPM_posY = strip_sizeY - 0.005 * cm;
-            G4Box* solidstrip = new G4Box("Strip", 2 * cm , strip_sizeY, 0.5 * cm);
-            G4Box* solidsurface= new G4Box("Surface", 2 * cm, surface_sizeY, 0.5 * cm);
-            G4Box* solidBC420 = new G4Box("BC420", 1.99 * cm, BC420_sizeY, 0.49 * cm);
-            G4Box* solidcut1 = new G4Box("Cut1", 1.1 * mm, cut1_sizeY, 0.05 * mm);
-            G4Box* solidcut2 = new G4Box("Cut2", 1.1 * mm, cut2_sizeY, 2.4 * mm);
-            G4Tubs* solidcut3 = new G4Tubs("Cut3", 0, 1.1 * mm, cut3_sizeZ, 0, 180 * deg);
-            G4Tubs* solidCladding = new G4Tubs("Cladding", 0.95 * mm , 1 * mm,  Cladding_sizeZ, 0, 360 * deg);
-            G4Tubs* solidCore = new G4Tubs("Core", 0, 0.95 * mm, Core_sizeZ, 0, 360 * deg);
-            auto logicstrip =
-              new G4LogicalVolume(solidstrip,
-                                 fAir,
-                                  "Strip");
-              new G4PVPlacement(rm,
-                                G4ThreeVector( strip_posX, strip_posY, strip_posZ ),
-                                logicstrip,
-                                "Strip",
-                                logicAl,
-                                false,
-                                i3,
-                                checkOverlaps);
-
-            auto logicsurface =
-              new G4LogicalVolume(solidsurface,
-                                  fsurface,
-                                  "Surface");
-            G4PVPlacement* physsurface =
-              new G4PVPlacement(nullptr,
-                                G4ThreeVector(),
-                                logicsurface,
-                                "Surface",
-                                logicstrip,
-                                false,
-                                i2,
-                                checkOverlaps);
-
-            auto logiccut1 = 
-              new G4LogicalVolume(solidcut1,
-	      	                fAir,
-	                        "Cut1");
-              new G4PVPlacement(nullptr,
-	  	              G4ThreeVector( 0, 0, 4.95 * mm),
-		                logiccut1,
-		                "Cut1",
-		                logicsurface,
-		                false,
-		                i2,
-	                  checkOverlaps);
-  
-            auto logicSiPM = new G4LogicalVolume(solidSiPM, fSiPM, "SiPM");
-            for ( G4int j = 0; j < 2; j++ )
-            {
-              G4PVPlacement* physSiPM = new G4PVPlacement(nullptr,
-                                                          G4ThreeVector( 0, ( 2 * j - 1 ) * SiPM_posY, 0),
-                                                          logicSiPM,
-                                                          "SiPM",
-                                                          logicsurface,
-                                                          false,
-                                                          j,
-                                                          checkOverlaps);
-            }
-
-            auto logicBC420 =
-              new G4LogicalVolume(solidBC420,
-                                  fBC420,
-                                  "BC420");
-            G4PVPlacement* physBC420 =
-              new G4PVPlacement(nullptr,
-                                G4ThreeVector(),
-                                logicBC420,
-                                "BC420",
-                                logicsurface,
-                                false,
-                                i2,
-                                checkOverlaps);  
-  
-          auto logiccut2 = 
-            new G4LogicalVolume(solidcut2,
-	  	                fAir,
- 	  	         	      "Cut2");
-            new G4PVPlacement(nullptr,
-	                            G4ThreeVector( 0, 0, 2.5 * mm),
-		                          logiccut2,
-		                          "Cut2",
-		                          logicBC420,
-		                          false,
-		                          i2,
-	                            checkOverlaps);
-
-	        auto logiccut3 =
-              new G4LogicalVolume(solidcut3,
-                                  fAir,
-                                  "Cut3");
-              new G4PVPlacement(rm_cut3,
-                                G4ThreeVector( 0, 0, 0.1 * mm),
-                                logiccut3,
-                                "Cut3",
-                                logicBC420,
-                                false,
-                                i2,
-                                checkOverlaps);
-
-
-            G4LogicalVolume* logicCladding =
-              new G4LogicalVolume(solidCladding,
-                                  fPethylene1,
-                                  "Cladding");
-            G4PVPlacement* physCladding =
-              new G4PVPlacement(rm_fiber,
-                                G4ThreeVector(),
-                                logicCladding,
-                                "Cladding",
-				logicBC420,
-				false,
-                                i3,
-                                checkOverlaps);
-
-            G4LogicalVolume* logicCore =
-              new G4LogicalVolume(solidCore,
-                                  fPMMA,
-                                  "Core");
-            G4PVPlacement* physCore =
-              new G4PVPlacement(rm_fiber,
-                                G4ThreeVector(),
-                                logicCore,
-                                "Core",
-                                logicBC420,
-                                false,
-                                i2,
-                                checkOverlaps);
-  
-            //define surface
-            G4OpticalSurface* Surface = new G4OpticalSurface("Surface");
-            new G4LogicalBorderSurface("Surface", physBC420, physsurface, Surface);
-            Surface->SetType(dielectric_metal);
-            Surface->SetFinish(polished);
-            Surface->SetModel(glisur);
-            G4double sur_Energy[] = { 2.38 * eV, 2.88 * eV, 3.45 * eV };
-            const G4int num = sizeof(sur_Energy) / sizeof(G4double);
-            G4double sur_RefractionIndex[] = { 1.58, 1.58, 1.58 };
-            assert(sizeof(sur_RefractionIndex) == sizeof(sur_Energy));
-            G4MaterialPropertiesTable* SURMPT = new G4MaterialPropertiesTable();
-            SURMPT->AddProperty("RINDEX", sur_Energy, sur_RefractionIndex,num);
-            Surface->SetMaterialPropertiesTable(SURMPT);
-
-            G4OpticalSurface* Cladding = new G4OpticalSurface("Cladding");
-            new G4LogicalBorderSurface("Surface", physCore, physCladding, Cladding);
-            Cladding->SetType(dielectric_metal);
-            Cladding->SetFinish(polished);
-            Cladding->SetModel(glisur);
-            G4double cladding_RefractionIndex[] = { 1.49, 1.49, 1.49 };
-            assert(sizeof(sur_RefractionIndex) == sizeof(sur_Energy));
-            G4MaterialPropertiesTable* CLAMPT = new G4MaterialPropertiesTable();
-            CLAMPT->AddProperty("RINDEX", sur_Energy, cladding_RefractionIndex,num);
-            Cladding->SetMaterialPropertiesTable(CLAMPT);
+            // copy numbers carry the channel fields, see ChannelId
+            new G4PVPlacement(rm,
+                              G4ThreeVector( strip_posX, strip_posY, strip_posZ ),
+                              logicstrip,
+                              "Strip",
+                              logicAl,
+                              false,
+                              ChannelId::StripCopyNo(i6, i2),
+                              fCheckOverlaps);
           }
         }
       }
     }
   }
+  if ( fVerboseLevel > 1 ) {
+    G4cout << "Sector modules: " << nofModules << " of "
+           << ChannelId::kHalves * ChannelId::kSectors
+           << ", strip templates: " << fStripTemplates.size()
+           << ", border surfaces: "
+           << G4LogicalBorderSurface::GetNumberOfBorderSurfaces() << G4endl;
+  }
+
   //
   //always return the physical World
   //
@@ -432,3 +460,509 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::ConstructSDandField()
+{
+  // sensitive detectors are thread-local, attach one to every SiPM;
+  // after /run/reinitializeGeometry the detector of this thread is
+  // attached to the new volumes again, so the pointers kept by the user
+  // actions stay valid
+  auto sdManager = G4SDManager::GetSDMpointer();
+  auto sipmSD = static_cast<SiPMSD*>(
+    sdManager->FindSensitiveDetector("SiPMSD", false));
+  if ( ! sipmSD ) {
+    sipmSD = new SiPMSD("SiPMSD", fPhotonBundleFactor);
+    sdManager->AddNewDetector(sipmSD);
+  }
+  SetSensitiveDetector("SiPM", sipmSD, true);
+
+  // the fast light model replaces optical tracking in the strips; the
+  // strip region outlives a geometry rebuild, and so does its model
+  if ( fFastLightModel && ! fStripLightModel ) {
+    fStripLightModel = new StripLightModel("StripLightModel", fStripRegion,
+                                           fLightResponseMap, sipmSD);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// build the strip (scintillator, slots, fiber and SiPMs) of the given
+// half-length once; all strips of the same length share the returned volume
+// (without /muon/detector/stripTemplates each call builds a new strip)
+G4LogicalVolume* DetectorConstruction::GetStripTemplate(G4double strip_sizeY)
+{
+  auto cached = fStripTemplates.find(strip_sizeY);
+  if ( cached != fStripTemplates.end() ) return cached->second;
+
+  G4double surface_sizeY = strip_sizeY;
+  G4double BC420_sizeY = strip_sizeY - 0.01 * cm;
+  G4double cut1_sizeY = BC420_sizeY;
+  G4double cut2_sizeY = BC420_sizeY;
+  G4double cut3_sizeZ = BC420_sizeY;
+  G4double Cladding_sizeZ = BC420_sizeY;
+  G4double Core_sizeZ = BC420_sizeY;
+  G4double SiPM_posY = strip_sizeY - 0.005 * cm;
+  G4Box* solidstrip = new G4Box("Strip", 2 * cm , strip_sizeY, 0.5 * cm);
+  G4Box* solidsurface= new G4Box("Surface", 2 * cm, surface_sizeY, 0.5 * cm);
+  G4Box* solidBC420 = new G4Box("BC420", 1.99 * cm, BC420_sizeY, 0.49 * cm);
+  G4Box* solidcut1 = new G4Box("Cut1", 1.1 * mm, cut1_sizeY, 0.05 * mm);
+  G4Box* solidcut2 = new G4Box("Cut2", 1.1 * mm, cut2_sizeY, 2.4 * mm);
+  G4Tubs* solidcut3 = new G4Tubs("Cut3", 0, 1.1 * mm, cut3_sizeZ, 0, 180 * deg);
+  G4Tubs* solidCladding = new G4Tubs("Cladding", 0.95 * mm , 1 * mm,  Cladding_sizeZ, 0, 360 * deg);
+  G4Tubs* solidCore = new G4Tubs("Core", 0, 0.95 * mm, Core_sizeZ, 0, 360 * deg);
+  auto logicstrip =
+    new G4LogicalVolume(solidstrip,
+                        fAir,
+                        "Strip");
+
+  auto logicsurface =
+    new G4LogicalVolume(solidsurface,
+                        fsurface,
+                        "Surface");
+  G4PVPlacement* physsurface =
+    new G4PVPlacement(nullptr,
+                      G4ThreeVector(),
+                      logicsurface,
+                      "Surface",
+                      logicstrip,
+                      false,
+                      0,
+                      fCheckOverlaps);
+
+  auto logiccut1 =
+    new G4LogicalVolume(solidcut1,
+                        fAir,
+                        "Cut1");
+    new G4PVPlacement(nullptr,
+                      G4ThreeVector( 0, 0, 4.95 * mm),
+                      logiccut1,
+                      "Cut1",
+                      logicsurface,
+                      false,
+                      0,
+                      fCheckOverlaps);
+
+  auto logicSiPM = new G4LogicalVolume(fSolidSiPM, fSiPM, "SiPM");
+  for ( G4int j = 0; j < 2; j++ )
+  {
+    new G4PVPlacement(nullptr,
+                      G4ThreeVector( 0, ( 2 * j - 1 ) * SiPM_posY, 0),
+                      logicSiPM,
+                      "SiPM",
+                      logicsurface,
+                      false,
+                      j,
+                      fCheckOverlaps);
+  }
+
+  auto logicBC420 =
+    new G4LogicalVolume(solidBC420,
+                        fBC420,
+                        "BC420");
+  G4PVPlacement* physBC420 =
+    new G4PVPlacement(nullptr,
+                      G4ThreeVector(),
+                      logicBC420,
+                      "BC420",
+                      logicsurface,
+                      false,
+                      0,
+                      fCheckOverlaps);
+
+  auto logiccut2 =
+    new G4LogicalVolume(solidcut2,
+                        fAir,
+                        "Cut2");
+    new G4PVPlacement(nullptr,
+                      G4ThreeVector( 0, 0, 2.5 * mm),
+                      logiccut2,
+                      "Cut2",
+                      logicBC420,
+                      false,
+                      0,
+                      fCheckOverlaps);
+
+  auto logiccut3 =
+    new G4LogicalVolume(solidcut3,
+                        fAir,
+                        "Cut3");
+    new G4PVPlacement(fFiberRotation,
+                      G4ThreeVector( 0, 0, 0.1 * mm),
+                      logiccut3,
+                      "Cut3",
+                      logicBC420,
+                      false,
+                      0,
+                      fCheckOverlaps);
+
+  G4LogicalVolume* logicCladding =
+    new G4LogicalVolume(solidCladding,
+                        fPethylene1,
+                        "Cladding");
+  G4PVPlacement* physCladding =
+    new G4PVPlacement(fFiberRotation,
+                      G4ThreeVector(),
+                      logicCladding,
+                      "Cladding",
+                      logicBC420,
+                      false,
+                      0,
+                      fCheckOverlaps);
+
+  G4LogicalVolume* logicCore =
+    new G4LogicalVolume(solidCore,
+                        fPMMA,
+                        "Core");
+  G4PVPlacement* physCore =
+    new G4PVPlacement(fFiberRotation,
+                      G4ThreeVector(),
+                      logicCore,
+                      "Core",
+                      logicBC420,
+                      false,
+                      0,
+                      fCheckOverlaps);
+
+  //attach the shared optical surfaces; the physical volumes are shared
+  //by all strips of this length, so one border surface pair per template
+  //covers every placement
+  new G4LogicalBorderSurface("Surface", physBC420, physsurface, fSurfaceOptical);
+  new G4LogicalBorderSurface("Cladding", physCore, physCladding, fCladdingOptical);
+
+  fStripRegion->AddRootLogicalVolume(logicstrip);
+  VolumeRoles::Set(logicstrip, VolumeRole::kStrip);
+  VolumeRoles::Set(logicsurface, VolumeRole::kSurface);
+  VolumeRoles::Set(logiccut1, VolumeRole::kSlot);
+  VolumeRoles::Set(logicSiPM, VolumeRole::kSiPM);
+  VolumeRoles::Set(logicBC420, VolumeRole::kScintillator);
+  VolumeRoles::Set(logiccut2, VolumeRole::kSlot);
+  VolumeRoles::Set(logiccut3, VolumeRole::kSlot);
+  VolumeRoles::Set(logicCladding, VolumeRole::kCladding);
+  VolumeRoles::Set(logicCore, VolumeRole::kFiberCore);
+
+  if ( fShareStripTemplates ) fStripTemplates[strip_sizeY] = logicstrip;
+  return logicstrip;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::DefineCommands()
+{
+  // Define /muon/detector command directory using generic messenger class
+  fMessenger = new G4GenericMessenger(this,
+                                      "/muon/detector/",
+                                      "Detector control");
+
+  auto& fastLightCmd
+    = fMessenger->DeclareProperty("fastLightModel", fFastLightModel,
+        "Replace optical tracking in the strips by the light response map.");
+  fastLightCmd.SetParameterName("fastLightModel", true);
+  fastLightCmd.SetDefaultValue("true");
+  fastLightCmd.SetStates(G4State_PreInit);
+
+  auto& mapCmd
+    = fMessenger->DeclareProperty("lightResponseMap", fLightResponseFile,
+        "Binary light response map used by the fast light model.");
+  mapCmd.SetParameterName("fileName", false);
+  mapCmd.SetStates(G4State_PreInit);
+
+  auto& cacheCmd
+    = fMessenger->DeclareProperty("geometryCache", fGeometryCacheDir,
+        "Directory of the GDML geometry cache, empty to always build.");
+  cacheCmd.SetParameterName("directory", false);
+  cacheCmd.SetStates(G4State_PreInit);
+
+  auto& templatesCmd
+    = fMessenger->DeclareProperty("stripTemplates", fShareStripTemplates,
+        "Share the strip volumes between strips of the same length.");
+  templatesCmd.SetParameterName("stripTemplates", true);
+  templatesCmd.SetDefaultValue("true");
+  templatesCmd.SetStates(G4State_PreInit);
+
+  auto& verboseCmd
+    = fMessenger->DeclareProperty("verbose", fVerboseLevel,
+        "Geometry printout: 0 none, 1 build time, 2 also the volume counts.");
+  verboseCmd.SetParameterName("level", false);
+  verboseCmd.SetRange("level>=0");
+
+  // the cuts can also be changed between runs, the material-cuts couples
+  // are updated at the next /run/beamOn
+  auto& absorberCutCmd
+    = fMessenger->DeclareMethodWithUnit("absorberCut", "mm",
+        &DetectorConstruction::SetAbsorberCut,
+        "Production cut in the Fe absorbers (FeAbsorberRegion).");
+  absorberCutCmd.SetParameterName("cut", false);
+  absorberCutCmd.SetRange("cut>0.");
+  absorberCutCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& supportCutCmd
+    = fMessenger->DeclareMethodWithUnit("supportCut", "mm",
+        &DetectorConstruction::SetSupportCut,
+        "Production cut in the Al supports (AlSupportRegion).");
+  supportCutCmd.SetParameterName("cut", false);
+  supportCutCmd.SetRange("cut>0.");
+  supportCutCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  auto& stripCutCmd
+    = fMessenger->DeclareMethodWithUnit("stripCut", "mm",
+        &DetectorConstruction::SetStripCut,
+        "Production cut in the strips (StripRegion).");
+  stripCutCmd.SetParameterName("cut", false);
+  stripCutCmd.SetRange("cut>0.");
+  stripCutCmd.SetStates(G4State_PreInit, G4State_Idle);
+
+  // partial detector, the geometry lives on the master only
+  auto& halvesCmd
+    = fMessenger->DeclareMethod("halves", &DetectorConstruction::SetHalves,
+        "z-halves to build (0: z < 0, 1: z > 0), list or all.");
+  auto& sectorsCmd
+    = fMessenger->DeclareMethod("sectors", &DetectorConstruction::SetSectors,
+        "Sectors to build (0-11), list or all.");
+  auto& layersCmd
+    = fMessenger->DeclareMethod("layers", &DetectorConstruction::SetLayers,
+        "Layers to build (0-5), list or all.");
+  for ( auto command : { &halvesCmd, &sectorsCmd, &layersCmd } ) {
+    command->SetParameterName("selection", false);
+    command->SetStates(G4State_PreInit, G4State_Idle);
+    command->command->SetToBeBroadcasted(false);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int DetectorConstruction::ParseSelection(const G4String& value, G4int size,
+                                           const G4String& what)
+{
+  if ( value == "all" ) return ( 1 << size ) - 1;
+
+  G4int mask = 0;
+  std::istringstream is(value);
+  G4int index;
+  while ( is >> index ) {
+    if ( index < 0 || index >= size ) {
+      G4ExceptionDescription msg;
+      msg << "No " << what << " " << index << ", the selection is unchanged.";
+      G4Exception("DetectorConstruction::ParseSelection()",
+        "MyCode0007", JustWarning, msg);
+      return -1;
+    }
+    mask |= 1 << index;
+  }
+  if ( ! is.eof() || mask == 0 ) {
+    G4ExceptionDescription msg;
+    msg << "No " << what << " in \"" << value
+        << "\", expected indices or all; the selection is unchanged.";
+    G4Exception("DetectorConstruction::ParseSelection()",
+      "MyCode0007", JustWarning, msg);
+    return -1;
+  }
+  return mask;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetHalves(G4String value)
+{
+  G4int mask = ParseSelection(value, ChannelId::kHalves, "z-half");
+  if ( mask < 0 ) return;
+  fHalfMask = mask;
+  if ( G4StateManager::GetStateManager()->GetCurrentState() == G4State_Idle ) {
+    G4RunManager::GetRunManager()->ReinitializeGeometry();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetSectors(G4String value)
+{
+  G4int mask = ParseSelection(value, ChannelId::kSectors, "sector");
+  if ( mask < 0 ) return;
+  fSectorMask = mask;
+  if ( G4StateManager::GetStateManager()->GetCurrentState() == G4State_Idle ) {
+    G4RunManager::GetRunManager()->ReinitializeGeometry();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetLayers(G4String value)
+{
+  G4int mask = ParseSelection(value, ChannelId::kLayers, "layer");
+  if ( mask < 0 ) return;
+  fLayerMask = mask;
+  if ( G4StateManager::GetStateManager()->GetCurrentState() == G4State_Idle ) {
+    G4RunManager::GetRunManager()->ReinitializeGeometry();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::CleanGeometry()
+{
+  // a rebuild starts from empty stores; deleting the logical volumes
+  // also removes them from the region root lists
+  G4GeometryManager::GetInstance()->OpenGeometry();
+  G4PhysicalVolumeStore::GetInstance()->Clean();
+  G4LogicalVolumeStore::GetInstance()->Clean();
+  G4SolidStore::GetInstance()->Clean();
+  G4LogicalBorderSurface::CleanSurfaceTable();
+
+  fStripTemplates.clear();
+  VolumeRoles::Clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4Region* DetectorConstruction::CreateRegion(const G4String& name,
+                                             G4double cut)
+{
+  auto region = G4RegionStore::GetInstance()->FindOrCreateRegion(name);
+  if ( ! region->GetProductionCuts() ) {
+    region->SetProductionCuts(new G4ProductionCuts);
+  }
+  region->GetProductionCuts()->SetProductionCut(cut);
+  return region;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetAbsorberCut(G4double cut)
+{
+  fAbsorberCut = cut;
+  if ( fAbsorberRegion ) CreateRegion(fAbsorberRegion->GetName(), cut);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetSupportCut(G4double cut)
+{
+  fSupportCut = cut;
+  if ( fSupportRegion ) CreateRegion(fSupportRegion->GetName(), cut);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetStripCut(G4double cut)
+{
+  fStripCut = cut;
+  if ( fStripRegion ) CreateRegion(fStripRegion->GetName(), cut);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String DetectorConstruction::GetGeometryCacheFile() const
+{
+  if ( fGeometryCacheDir.empty() ) return "";
+
+  // everything Construct() depends on
+  std::ostringstream key;
+  key.precision(17);
+  key << kGeometryVersion << " " << fHalfMask << " " << fSectorMask
+      << " " << fLayerMask << " " << fShareStripTemplates;
+
+  // materials with their composition, Birks constant and optical tables
+  for ( auto material : { fBC420, fAir, fSiPM, fsurface, fPMMA, fPethylene1,
+                          fFe, fAl } ) {
+    key << " " << material->GetName() << " " << material->GetDensity()
+        << " " << material->GetIonisation()->GetBirksConstant();
+    for ( std::size_t i = 0; i < material->GetNumberOfElements(); ++i ) {
+      key << " " << material->GetElement(i)->GetName()
+          << " " << material->GetFractionVector()[i];
+    }
+    AppendProperties(key, material->GetMaterialPropertiesTable());
+  }
+
+  // optical surfaces of the border surfaces
+  for ( auto surface : { fSurfaceOptical, fCladdingOptical } ) {
+    key << " " << surface->GetName() << " " << surface->GetType()
+        << " " << surface->GetModel() << " " << surface->GetFinish()
+        << " " << surface->GetSigmaAlpha() << " " << surface->GetPolish();
+    AppendProperties(key, surface->GetMaterialPropertiesTable());
+  }
+
+  return fGeometryCacheDir + "/muon_geometry_" + ParameterHash(key.str())
+         + ".gdml";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4VPhysicalVolume* DetectorConstruction::ReadGeometryCache(
+  const G4String& fileName)
+{
+#ifdef G4LIB_USE_GDML
+  if ( ! std::ifstream(fileName).good() ) return nullptr;
+
+  G4GDMLParser parser;
+  parser.Read(fileName, false);
+  G4VPhysicalVolume* world = parser.GetWorldVolume();
+  if ( ! world ) return nullptr;
+
+  // the names are stripped of the GDML references when reading
+  G4VisAttributes* blank = new G4VisAttributes(false);
+  for ( auto volume : *G4LogicalVolumeStore::GetInstance() ) {
+    const G4String& name = volume->GetName();
+    VolumeRole role = VolumeRole::kOther;
+    for ( G4int i = 0; i < G4int(VolumeRole::kNumRoles); ++i ) {
+      if ( name == VolumeRoles::GetName(VolumeRole(i)) ) role = VolumeRole(i);
+    }
+    if ( name.compare(0, 3, "Cut") == 0 ) role = VolumeRole::kSlot;
+    VolumeRoles::Set(volume, role);
+
+    switch ( role ) {
+      case VolumeRole::kWorld:
+      case VolumeRole::kEnvelope:
+        volume->SetVisAttributes(blank);
+        break;
+      case VolumeRole::kAbsorber:
+        fAbsorberRegion->AddRootLogicalVolume(volume);
+        break;
+      case VolumeRole::kSupport:
+        fSupportRegion->AddRootLogicalVolume(volume);
+        break;
+      case VolumeRole::kStrip:
+        fStripRegion->AddRootLogicalVolume(volume);
+        break;
+      case VolumeRole::kScintillator:
+        // GDML does not store the Birks constant
+        volume->GetMaterial()->GetIonisation()->SetBirksConstant(
+          fBC420->GetIonisation()->GetBirksConstant());
+        break;
+      default:
+        break;
+    }
+  }
+  return world;
+#else
+  G4Exception("DetectorConstruction::ReadGeometryCache()", "MyCode0008",
+    JustWarning, "Built without GDML, the geometry cache is not used.");
+  (void)fileName;
+  return nullptr;
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::WriteGeometryCache(G4VPhysicalVolume* world,
+                                              const G4String& fileName)
+{
+#ifdef G4LIB_USE_GDML
+  // write under a private name and rename, so that concurrent jobs never
+  // read a partial file
+  std::ostringstream tmpName;
+  tmpName << fileName.substr(0, fileName.size() - 5) << "_" << getpid()
+          << ".gdml";
+  G4GDMLParser parser;
+  parser.Write(tmpName.str(), world, true);
+  if ( std::rename(tmpName.str().c_str(), fileName.c_str()) != 0 ) {
+    std::remove(tmpName.str().c_str());
+  }
+  else if ( fVerboseLevel > 0 ) {
+    G4cout << "Geometry written to " << fileName << G4endl;
+  }
+#else
+  (void)world;
+  (void)fileName;
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -1,15 +1,42 @@
 #include "EventAction.hh"
 #include "RunAction.hh"
+#include "SiPMHit.hh"
+#include "SiPMDigi.hh"
+#include "SiPMDigitizer.hh"
+#include "Run.hh"
+#include "CalibrationScan.hh"
+#include "ChannelId.hh"
+#include "AsyncEventWriter.hh"
 
 #include "G4Event.hh"
 #include "G4RunManager.hh"
+#include "G4HCofThisEvent.hh"
+#include "G4SDManager.hh"
+#include "G4DigiManager.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <utility>
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 EventAction::EventAction(RunAction* runAction)
 : G4UserEventAction(),
-  fRunAction(runAction)
-{} 
+  fRunAction(runAction),
+  fDigitizer(nullptr),
+  fSiPMHCID(-1),
+  fSiPMDCID(-1),
+  fOpticalBoundarySteps(0.),
+  fOpticalTracks(0.),
+  fVisibleEdep(0.),
+  fCalibrating(false),
+  fCalibrationStrip(-1),
+  fStripEdep(ChannelId::kNumStrips, 0.),
+  fDetectingEnds(ChannelId::kNumStrips, 0)
+{
+  // the digitizer module is owned by the digitization manager
+  fDigitizer = new SiPMDigitizer("SiPMDigitizer");
+  G4DigiManager::GetDMpointer()->AddNewModule(fDigitizer);
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -19,11 +46,154 @@ EventAction::~EventAction()
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void EventAction::BeginOfEventAction(const G4Event*)
-{}
+{
+  fOpticalBoundarySteps = 0.;
+  fOpticalTracks = 0.;
+  fVisibleEdep = 0.;
+  auto calibration = CalibrationScan::Instance();
+  fCalibrating = calibration->IsActive();
+  fCalibrationStrip
+    = fCalibrating ? calibration->GetChannel(0) / ChannelId::kEnds : -1;
+
+  for ( auto strip : fHitStrips ) fStripEdep[strip] = 0.;
+  fHitStrips.clear();
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void EventAction::EndOfEventAction(const G4Event*)
-{}
+void EventAction::AddStripEdep(G4int strip, G4double edep)
+{
+  if ( fStripEdep[strip] == 0. ) fHitStrips.push_back(strip);
+  fStripEdep[strip] += edep;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventAction::EndOfEventAction(const G4Event* event)
+{
+  // accumulate statistics in run action
+  fRunAction->AddOpticalBoundarySteps(fOpticalBoundarySteps);
+  fRunAction->AddOpticalTracks(fOpticalTracks);
+
+  if ( fSiPMHCID < 0 ) {
+    fSiPMHCID = G4SDManager::GetSDMpointer()->GetCollectionID("SiPMSD/SiPMColl");
+  }
+  auto hce = event->GetHCofThisEvent();
+  if ( ! hce ) return;
+  auto hitsCollection = static_cast<SiPMHitsCollection*>(hce->GetHC(fSiPMHCID));
+  if ( ! hitsCollection ) return;
+
+  G4int nofHits = hitsCollection->entries();
+  G4int photoelectrons = 0;
+  for ( G4int i = 0; i < nofHits; ++i ) {
+    photoelectrons += (*hitsCollection)[i]->GetPhotoelectrons();
+  }
+  fRunAction->AddSiPMHits(nofHits, photoelectrons);
+  RecordStripResponse(hitsCollection);
+
+  // SiPM response, after the run statistics of the detected photons
+  const SiPMDigiCollection* digiCollection = nullptr;
+  if ( fDigitizer->IsEnabled() ) {
+    auto digiManager = G4DigiManager::GetDMpointer();
+    fDigitizer->Digitize();
+    if ( fSiPMDCID < 0 ) {
+      fSiPMDCID
+        = digiManager->GetDigiCollectionID("SiPMDigitizer/SiPMDigiColl");
+    }
+    digiCollection = static_cast<const SiPMDigiCollection*>(
+      digiManager->GetDigiCollection(fSiPMDCID));
+    G4int cells = 0;
+    for ( std::size_t i = 0; i < digiCollection->entries(); ++i ) {
+      cells += (*digiCollection)[i]->GetAvalanches();
+    }
+    fRunAction->AddSiPMCells(cells);
+  }
+
+  // columnar event output, handed over to the writer thread
+  auto writer = fRunAction->GetEventWriter();
+  if ( writer && digiCollection ) {
+    G4int nofDigis = digiCollection->entries();
+    EventRecord record;
+    record.eventId = event->GetEventID();
+    record.channel.reserve(nofDigis);
+    record.photoelectrons.reserve(nofDigis);
+    record.time.reserve(nofDigis);
+    for ( G4int i = 0; i < nofDigis; ++i ) {
+      auto digi = (*digiCollection)[i];
+      record.channel.push_back(ChannelId::FromIndex(digi->GetChannel()));
+      record.photoelectrons.push_back(digi->GetAvalanches());
+      record.time.push_back(digi->GetTime() / ns);
+    }
+    writer->Push(std::move(record));
+  }
+  else if ( writer ) {
+    EventRecord record;
+    record.eventId = event->GetEventID();
+    record.channel.reserve(nofHits);
+    record.photoelectrons.reserve(nofHits);
+    record.time.reserve(nofHits);
+    for ( G4int i = 0; i < nofHits; ++i ) {
+      auto hit = (*hitsCollection)[i];
+      record.channel.push_back(ChannelId::FromIndex(hit->GetChannel()));
+      record.photoelectrons.push_back(hit->GetPhotoelectrons());
+      record.time.push_back(hit->GetTime() / ns);
+    }
+    writer->Push(std::move(record));
+  }
+
+  if ( fCalibrating ) RecordCalibration(event, hitsCollection);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventAction::RecordStripResponse(const SiPMHitsCollection* hitsCollection)
+{
+  // the run of this thread, filled without locks and merged at the end
+  auto run = static_cast<Run*>(
+    G4RunManager::GetRunManager()->GetNonConstCurrentRun());
+  G4double threshold = fRunAction->GetPeThreshold();
+
+  for ( std::size_t i = 0; i < hitsCollection->entries(); ++i ) {
+    auto hit = (*hitsCollection)[i];
+    G4bool above = hit->GetPhotoelectrons() >= threshold;
+    run->AddChannelHit(hit->GetChannel(), hit->GetPhotoelectrons(), above);
+    if ( above ) ++fDetectingEnds[hit->GetChannel() / ChannelId::kEnds];
+  }
+
+  // a crossed strip is detected when both ends are above threshold
+  G4double crossingEdep = fRunAction->GetCrossingEdep();
+  for ( auto strip : fHitStrips ) {
+    if ( fStripEdep[strip] < crossingEdep ) continue;
+    run->AddStripCrossing(strip, fDetectingEnds[strip] == ChannelId::kEnds);
+  }
+
+  for ( std::size_t i = 0; i < hitsCollection->entries(); ++i ) {
+    fDetectingEnds[(*hitsCollection)[i]->GetChannel() / ChannelId::kEnds] = 0;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventAction::RecordCalibration(const G4Event* event,
+                                    const SiPMHitsCollection* hitsCollection)
+{
+  // photons and first arrival time at both ends of the scanned strip
+  auto calibration = CalibrationScan::Instance();
+  G4int pe[2] = { 0, 0 };
+  G4double time[2] = { 0., 0. };
+  for ( std::size_t i = 0; i < hitsCollection->entries(); ++i ) {
+    auto hit = (*hitsCollection)[i];
+    for ( G4int end = 0; end < 2; ++end ) {
+      if ( hit->GetChannel() != calibration->GetChannel(end) ) continue;
+      pe[end] = hit->GetPhotoelectrons();
+      time[end] = hit->GetTime();
+    }
+  }
+
+  auto run = static_cast<Run*>(
+    G4RunManager::GetRunManager()->GetNonConstCurrentRun());
+  run->AddCalibrationEvent(calibration->GetCell(event->GetEventID()),
+                           pe, time, fVisibleEdep);
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,389 @@
+#include "EventFormat.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef MUON_USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace EventFormat
+{
+
+namespace
+{
+  // a block is written when either limit is reached
+  const std::size_t kBlockEvents = 4096;
+  const std::size_t kBlockHits = 1 << 18;
+  const std::size_t kFileBufferSize = 4 << 20;
+
+  template <typename T>
+  void WriteColumn(std::FILE* file, const std::vector<T>& column)
+  {
+    if ( ! column.empty() ) {
+      std::fwrite(column.data(), sizeof(T), column.size(), file);
+    }
+  }
+
+  template <typename T>
+  void PutColumn(std::vector<char>& bytes, const std::vector<T>& column)
+  {
+    std::size_t size = bytes.size();
+    bytes.resize(size + column.size() * sizeof(T));
+    if ( ! column.empty() ) {
+      std::memcpy(bytes.data() + size, column.data(), column.size() * sizeof(T));
+    }
+  }
+
+  template <typename T>
+  void AppendColumn(std::vector<T>& column, const char* data,
+                    std::size_t first, std::size_t count)
+  {
+    std::size_t size = column.size();
+    column.resize(size + count);
+    if ( count ) {
+      std::memcpy(column.data() + size, data + first * sizeof(T),
+                  count * sizeof(T));
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::uint64_t GetPayloadSize(std::uint32_t nEvents, std::uint32_t nHits)
+{
+  return std::uint64_t(nEvents) * sizeof(std::int32_t)
+       + std::uint64_t(nEvents + 1) * sizeof(std::uint32_t)
+       + std::uint64_t(nHits) * ( 2 * sizeof(std::uint32_t) + sizeof(float) );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool HasCompression()
+{
+#ifdef MUON_USE_ZLIB
+  return true;
+#else
+  return false;
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventColumns::Clear()
+{
+  eventId.clear();
+  hitOffset.assign(1, 0);
+  channel.clear();
+  photoelectrons.clear();
+  time.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventColumns::AppendBlock(const BlockHeader& header, const char* payload,
+                               std::size_t first, std::size_t count)
+{
+  if ( hitOffset.empty() ) hitOffset.push_back(0);
+
+  const char* ids = payload;
+  const char* offsets = ids + header.nEvents * sizeof(std::int32_t);
+  const char* channels = offsets + ( header.nEvents + 1 ) * sizeof(std::uint32_t);
+  const char* npes = channels + header.nHits * sizeof(std::uint32_t);
+  const char* times = npes + header.nHits * sizeof(std::uint32_t);
+
+  std::vector<std::uint32_t> blockOffsets;
+  AppendColumn(blockOffsets, offsets, first, count + 1);
+  std::uint32_t firstHit = blockOffsets.front();
+  std::uint32_t nHits = blockOffsets.back() - firstHit;
+
+  std::uint32_t base = channel.size();
+  AppendColumn(eventId, ids, first, count);
+  for ( std::size_t i = 1; i <= count; ++i ) {
+    hitOffset.push_back(base + blockOffsets[i] - firstHit);
+  }
+  AppendColumn(channel, channels, firstHit, nHits);
+  AppendColumn(photoelectrons, npes, firstHit, nHits);
+  AppendColumn(time, times, firstHit, nHits);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Writer::Writer()
+: fFile(nullptr),
+  fCompressionLevel(0),
+  fUncompressedBytes(0),
+  fOffset(0),
+  fNEvents(0),
+  fNHits(0)
+{
+  fColumns.Clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Writer::~Writer()
+{
+  Close();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool Writer::Open(const std::string& fileName)
+{
+  Close();
+  fFile = std::fopen(fileName.c_str(), "wb");
+  if ( ! fFile ) return false;
+
+  fFileBuffer.resize(kFileBufferSize);
+  std::setvbuf(fFile, fFileBuffer.data(), _IOFBF, fFileBuffer.size());
+
+  FileHeader header = { kFileMagic, kVersion };
+  std::fwrite(&header, sizeof(header), 1, fFile);
+  fOffset = sizeof(header);
+  fNEvents = fNHits = 0;
+  fUncompressedBytes = sizeof(header);
+  fIndex.clear();
+  fColumns.Clear();
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Writer::Close()
+{
+  if ( ! fFile ) return;
+  FlushBlock();
+
+  IndexTrailer trailer = { fOffset, fIndex.size(), kIndexMagic, 0 };
+  WriteColumn(fFile, fIndex);
+  std::fwrite(&trailer, sizeof(trailer), 1, fFile);
+  std::fclose(fFile);
+  fFile = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Writer::BeginEvent(std::int32_t eventId)
+{
+  fColumns.eventId.push_back(eventId);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Writer::EndEvent()
+{
+  fColumns.hitOffset.push_back(fColumns.channel.size());
+  if ( fColumns.GetNEvents() >= kBlockEvents
+       || fColumns.GetNHits() >= kBlockHits ) FlushBlock();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Writer::FlushBlock()
+{
+  std::uint32_t nEvents = fColumns.GetNEvents();
+  if ( nEvents == 0 ) return;
+  std::uint32_t nHits = fColumns.GetNHits();
+
+  BlockHeader header
+    = { kBlockMagic, nEvents, nHits, 0, GetPayloadSize(nEvents, nHits) };
+  fUncompressedBytes += sizeof(header) + header.payloadSize;
+
+  fPayload.clear();
+  PutColumn(fPayload, fColumns.eventId);
+  PutColumn(fPayload, fColumns.hitOffset);
+  PutColumn(fPayload, fColumns.channel);
+  PutColumn(fPayload, fColumns.photoelectrons);
+  PutColumn(fPayload, fColumns.time);
+
+  const std::vector<char>* payload = &fPayload;
+#ifdef MUON_USE_ZLIB
+  if ( fCompressionLevel > 0 ) {
+    uLongf size = compressBound(fPayload.size());
+    fCompressed.resize(size);
+    if ( compress2(reinterpret_cast<Bytef*>(fCompressed.data()), &size,
+                   reinterpret_cast<const Bytef*>(fPayload.data()),
+                   fPayload.size(), fCompressionLevel) == Z_OK
+         && size < fPayload.size() ) {
+      fCompressed.resize(size);
+      header.flags |= kCompressed;
+      header.payloadSize = size;
+      payload = &fCompressed;
+    }
+  }
+#endif
+  std::fwrite(&header, sizeof(header), 1, fFile);
+  WriteColumn(fFile, *payload);
+
+  fIndex.push_back({ fOffset, fNEvents, nEvents, nHits });
+  fOffset += sizeof(header) + header.payloadSize;
+  fNEvents += nEvents;
+  fNHits += nHits;
+  fColumns.Clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Reader::Reader()
+: fFile(nullptr)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Reader::~Reader()
+{
+  Close();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool Reader::Open(const std::string& fileName)
+{
+  Close();
+  fFile = std::fopen(fileName.c_str(), "rb");
+  if ( ! fFile ) return false;
+
+  FileHeader header;
+  if ( std::fread(&header, sizeof(header), 1, fFile) != 1
+       || header.magic != kFileMagic || header.version != kVersion ) {
+    Close();
+    return false;
+  }
+  if ( ! ReadIndex() && ! ScanBlocks() ) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Reader::Close()
+{
+  if ( fFile ) std::fclose(fFile);
+  fFile = nullptr;
+  fIndex.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::uint64_t Reader::GetNEvents() const
+{
+  if ( fIndex.empty() ) return 0;
+  return fIndex.back().firstEvent + fIndex.back().nEvents;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool Reader::Read(std::uint64_t first, std::uint64_t count,
+                  EventColumns& columns)
+{
+  columns.Clear();
+  std::uint64_t last = std::min(first + count, GetNEvents());
+
+  std::vector<char> bytes;
+  for ( std::size_t block = 0; block < fIndex.size(); ++block ) {
+    const BlockIndex& entry = fIndex[block];
+    std::uint64_t blockEnd = entry.firstEvent + entry.nEvents;
+    if ( blockEnd <= first || entry.firstEvent >= last ) continue;
+    if ( ! ReadBlock(block, bytes) || ! DecodeBlock(bytes) ) return false;
+
+    BlockHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    std::uint64_t from = std::max(first, entry.firstEvent) - entry.firstEvent;
+    std::uint64_t to = std::min(last, blockEnd) - entry.firstEvent;
+    columns.AppendBlock(header, bytes.data() + sizeof(header), from, to - from);
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool Reader::ReadBlock(std::size_t block, std::vector<char>& bytes)
+{
+  BlockHeader header;
+  if ( std::fseek(fFile, fIndex[block].offset, SEEK_SET) != 0
+       || std::fread(&header, sizeof(header), 1, fFile) != 1
+       || header.magic != kBlockMagic ) return false;
+
+  bytes.resize(sizeof(header) + header.payloadSize);
+  std::memcpy(bytes.data(), &header, sizeof(header));
+  return std::fread(bytes.data() + sizeof(header), 1, header.payloadSize, fFile)
+         == header.payloadSize;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool Reader::DecodeBlock(std::vector<char>& bytes)
+{
+  BlockHeader header;
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  if ( ! ( header.flags & kCompressed ) ) return true;
+
+#ifdef MUON_USE_ZLIB
+  uLongf size = GetPayloadSize(header.nEvents, header.nHits);
+  std::vector<char> decoded(sizeof(header) + size);
+  if ( uncompress(reinterpret_cast<Bytef*>(decoded.data() + sizeof(header)),
+                  &size,
+                  reinterpret_cast<const Bytef*>(bytes.data() + sizeof(header)),
+                  header.payloadSize) != Z_OK
+       || size != GetPayloadSize(header.nEvents, header.nHits) ) return false;
+
+  header.flags &= ~kCompressed;
+  header.payloadSize = size;
+  std::memcpy(decoded.data(), &header, sizeof(header));
+  bytes.swap(decoded);
+  return true;
+#else
+  return false;
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool Reader::ReadIndex()
+{
+  IndexTrailer trailer;
+  if ( std::fseek(fFile, -long(sizeof(trailer)), SEEK_END) != 0
+       || std::fread(&trailer, sizeof(trailer), 1, fFile) != 1
+       || trailer.magic != kIndexMagic ) return false;
+
+  fIndex.resize(trailer.nBlocks);
+  if ( std::fseek(fFile, trailer.indexOffset, SEEK_SET) != 0
+       || std::fread(fIndex.data(), sizeof(BlockIndex), fIndex.size(), fFile)
+          != fIndex.size() ) {
+    fIndex.clear();
+    return false;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool Reader::ScanBlocks()
+{
+  // no index: walk the block headers until the first incomplete block
+  fIndex.clear();
+  std::uint64_t offset = sizeof(FileHeader);
+  std::uint64_t nEvents = 0;
+  BlockHeader header;
+  while ( std::fseek(fFile, offset, SEEK_SET) == 0
+          && std::fread(&header, sizeof(header), 1, fFile) == 1
+          && header.magic == kBlockMagic
+          && ( ( header.flags & kCompressed )
+               || header.payloadSize
+                  == GetPayloadSize(header.nEvents, header.nHits) ) ) {
+    std::uint64_t next = offset + sizeof(header) + header.payloadSize;
+    if ( std::fseek(fFile, next - 1, SEEK_SET) != 0
+         || std::fgetc(fFile) == EOF ) break;
+    fIndex.push_back({ offset, nEvents, header.nEvents, header.nHits });
+    nEvents += header.nEvents;
+    offset = next;
+  }
+  return true;
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
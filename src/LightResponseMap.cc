@@ -0,0 +1,187 @@
+#include "LightResponseMap.hh"
+
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4Poisson.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+  const char kMagic[8] = { 'M', 'U', 'L', 'R', 'M', 'A', 'P', '1' };
+
+  // analytic model used until a calibration map is read
+  const G4double kPePerMeV = 20.;
+  const G4double kAttenuationLength = 3.5 * m;
+  const G4double kEffectiveSpeed = c_light / 1.6;
+  const G4double kTimeSpread = 1.5 * ns;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+LightResponseMap::LightResponseMap()
+: fNAlong(0),
+  fNAcross(0),
+  fHalfLength(0.),
+  fHalfWidth(0.),
+  fCalibrated(false)
+{
+  SetGrid(80, 4, 200 * cm, 2 * cm);
+  FillAnalytic();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+LightResponseMap::~LightResponseMap()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void LightResponseMap::SetGrid(G4int nAlong, G4int nAcross,
+                               G4double halfLength, G4double halfWidth)
+{
+  fNAlong = nAlong;
+  fNAcross = nAcross;
+  fHalfLength = halfLength;
+  fHalfWidth = halfWidth;
+  fRecords.assign(2 * fNAlong * fNAcross, Record());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void LightResponseMap::FillAnalytic()
+{
+  fCalibrated = false;
+  for ( G4int cell = 0; cell < GetNCells(); ++cell ) {
+    G4double y = GetCellAlong(cell);
+    for ( G4int end = 0; end < 2; ++end ) {
+      G4double distance = end == 0 ? fHalfLength + y : fHalfLength - y;
+      Record& record = GetRecord(cell, end);
+      record.events = 0;
+      record.meanEdep = 1.;
+      record.meanPe = kPePerMeV * std::exp(-distance / kAttenuationLength);
+      record.varPe = record.meanPe;
+      record.meanTime = distance / kEffectiveSpeed / ns;
+      record.rmsTime = kTimeSpread / ns;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool LightResponseMap::Read(const G4String& fileName)
+{
+  std::ifstream file(fileName, std::ios::binary);
+  if ( ! file ) return false;
+
+  char magic[8];
+  std::int32_t nAlong, nAcross;
+  float halfLength, halfWidth;
+  file.read(magic, sizeof(magic));
+  file.read(reinterpret_cast<char*>(&nAlong), sizeof(nAlong));
+  file.read(reinterpret_cast<char*>(&nAcross), sizeof(nAcross));
+  file.read(reinterpret_cast<char*>(&halfLength), sizeof(halfLength));
+  file.read(reinterpret_cast<char*>(&halfWidth), sizeof(halfWidth));
+  if ( ! file || std::memcmp(magic, kMagic, sizeof(magic)) != 0
+       || nAlong <= 0 || nAcross <= 0 ) {
+    G4cerr << "LightResponseMap: " << fileName
+           << " is not a light response map." << G4endl;
+    return false;
+  }
+
+  std::vector<Record> records(2 * nAlong * nAcross);
+  file.read(reinterpret_cast<char*>(records.data()),
+            records.size() * sizeof(Record));
+  if ( ! file ) {
+    G4cerr << "LightResponseMap: " << fileName << " is truncated." << G4endl;
+    return false;
+  }
+
+  fNAlong = nAlong;
+  fNAcross = nAcross;
+  fHalfLength = halfLength * mm;
+  fHalfWidth = halfWidth * mm;
+  fRecords.swap(records);
+  fCalibrated = true;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool LightResponseMap::Write(const G4String& fileName) const
+{
+  std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+  if ( ! file ) return false;
+
+  std::int32_t nAlong = fNAlong;
+  std::int32_t nAcross = fNAcross;
+  float halfLength = fHalfLength / mm;
+  float halfWidth = fHalfWidth / mm;
+  file.write(kMagic, sizeof(kMagic));
+  file.write(reinterpret_cast<const char*>(&nAlong), sizeof(nAlong));
+  file.write(reinterpret_cast<const char*>(&nAcross), sizeof(nAcross));
+  file.write(reinterpret_cast<const char*>(&halfLength), sizeof(halfLength));
+  file.write(reinterpret_cast<const char*>(&halfWidth), sizeof(halfWidth));
+  file.write(reinterpret_cast<const char*>(fRecords.data()),
+             fRecords.size() * sizeof(Record));
+  return bool(file);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double LightResponseMap::GetCellAlong(G4int cell) const
+{
+  G4int iAlong = cell / fNAcross;
+  return ( 2. * ( iAlong + 0.5 ) / fNAlong - 1. ) * fHalfLength;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double LightResponseMap::GetCellAcross(G4int cell) const
+{
+  G4int iAcross = cell % fNAcross;
+  return ( 2. * ( iAcross + 0.5 ) / fNAcross - 1. ) * fHalfWidth;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const LightResponseMap::Record&
+LightResponseMap::Find(G4int end, G4double distance, G4double offset) const
+{
+  // position along the calibrated strip with the same distance to the SiPM
+  G4double y = end == 0 ? distance - fHalfLength : fHalfLength - distance;
+  G4int iAlong = G4int( ( y + fHalfLength ) / ( 2. * fHalfLength ) * fNAlong );
+  G4int iAcross = G4int( ( offset + fHalfWidth ) / ( 2. * fHalfWidth ) * fNAcross );
+  iAlong = std::min(std::max(iAlong, 0), fNAlong - 1);
+  iAcross = std::min(std::max(iAcross, 0), fNAcross - 1);
+  return GetRecord(iAlong * fNAcross + iAcross, end);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int LightResponseMap::SamplePhotoelectrons(const Record& record,
+                                             G4double visibleEdep) const
+{
+  if ( record.meanPe <= 0. || record.meanEdep <= 0. ) return 0;
+  G4double mean = record.meanPe / record.meanEdep * visibleEdep / MeV;
+
+  // Poisson unless the calibration saw a wider spread
+  G4double relVariance = record.varPe / record.meanPe;
+  if ( relVariance <= 1. ) return G4int(G4Poisson(mean));
+  G4double npe = G4RandGauss::shoot(mean, std::sqrt(relVariance * mean));
+  return npe > 0. ? G4int(npe + 0.5) : 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double LightResponseMap::SampleArrivalTime(const Record& record) const
+{
+  G4double time = G4RandGauss::shoot(record.meanTime, record.rmsTime) * ns;
+  return std::max(time, 0.);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
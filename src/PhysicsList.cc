@@ -0,0 +1,63 @@
+#include "PhysicsList.hh"
+#include "PhysicsTableCache.hh"
+
+#include "G4EmStandardPhysics_option4.hh"
+#include "G4OpticalPhysics.hh"
+#include "G4FastSimulationPhysics.hh"
+
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhysicsList::PhysicsList(Mode mode, G4int photonBundleFactor)
+: FTFP_BERT(),
+  fMode(mode)
+{
+  ReplacePhysics(new G4EmStandardPhysics_option4());
+
+  if ( fMode == Mode::kFull ) {
+    G4OpticalPhysics* opticalPhysics = new G4OpticalPhysics();
+    opticalPhysics->SetWLSTimeProfile("delta");
+    // with photon bundling (-b N) every scintillation photon stands for N
+    opticalPhysics->SetScintillationYieldFactor(1.0 / photonBundleFactor);
+    opticalPhysics->SetScintillationExcitationRatio(0.0);
+    opticalPhysics->SetMaxNumPhotonsPerStep(100);
+    opticalPhysics->SetMaxBetaChangePerStep(10.0);
+    opticalPhysics->SetTrackSecondariesFirst(kCerenkov, true);
+    opticalPhysics->SetTrackSecondariesFirst(kScintillation, true);
+    RegisterPhysics(opticalPhysics);
+  }
+
+  // fast simulation process for the strip light model
+  // (/muon/detector/fastLightModel)
+  G4FastSimulationPhysics* fastSimulationPhysics = new G4FastSimulationPhysics();
+  for ( auto particleName : { "mu-", "mu+", "e-", "e+", "pi-", "pi+", "proton" } ) {
+    fastSimulationPhysics->ActivateFastSimulation(particleName);
+  }
+  RegisterPhysics(fastSimulationPhysics);
+
+  // physics table cache (/muon/physics/tableCache), keyed with the
+  // configuration of this list
+  std::ostringstream configuration;
+  configuration << "FTFP_BERT_option4 "
+                << ( fMode == Mode::kFull ? "full " : "edep " )
+                << photonBundleFactor;
+  new PhysicsTableCache(this, configuration.str());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhysicsList::~PhysicsList()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PhysicsList::GetModeFromName(const G4String& name, Mode& mode)
+{
+  if ( name == "full" ) mode = Mode::kFull;
+  else if ( name == "edep" ) mode = Mode::kEdep;
+  else return false;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
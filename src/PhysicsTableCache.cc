@@ -0,0 +1,136 @@
+#include "PhysicsTableCache.hh"
+#include "ParameterHash.hh"
+
+#include "G4VUserPhysicsList.hh"
+#include "G4GenericMessenger.hh"
+#include "G4StateManager.hh"
+#include "G4ProductionCutsTable.hh"
+#include "G4ProductionCuts.hh"
+#include "G4RegionStore.hh"
+#include "G4Region.hh"
+#include "G4Material.hh"
+#include "G4Element.hh"
+#include "G4Version.hh"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhysicsTableCache::PhysicsTableCache(G4VUserPhysicsList* physicsList,
+                                     const G4String& configuration)
+: G4VStateDependent(),
+  fPhysicsList(physicsList),
+  fConfiguration(configuration),
+  fMessenger(nullptr),
+  fConfigured(false),
+  fRetrieving(false)
+{
+  fMessenger = new G4GenericMessenger(this, "/muon/physics/",
+                                      "Physics table cache");
+  auto& dirCmd
+    = fMessenger->DeclareProperty("tableCache", fDirectory,
+        "Directory of the physics table cache, empty to always build.");
+  dirCmd.SetParameterName("directory", false);
+  dirCmd.SetStates(G4State_PreInit, G4State_Idle);
+  dirCmd.SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhysicsTableCache::~PhysicsTableCache()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PhysicsTableCache::Notify(G4ApplicationState requestedState)
+{
+  if ( fDirectory.empty() ) return true;
+
+  // the couples are only created by the run initialization, not by
+  // /run/initialize
+  auto currentState = G4StateManager::GetStateManager()->GetCurrentState();
+  G4bool hasCouples
+    = G4ProductionCutsTable::GetProductionCutsTable()->GetTableSize() > 0;
+
+  if ( ! fConfigured && ! hasCouples
+       && currentState == G4State_Idle && requestedState == G4State_Init ) {
+    // the tables are built next
+    fConfigured = true;
+    fTableDirectory = fDirectory + "/" + GetKey();
+    struct stat info;
+    fRetrieving = ( stat(fTableDirectory.c_str(), &info) == 0 );
+    if ( fRetrieving ) {
+      G4cout << "Retrieving the physics tables from " << fTableDirectory
+             << G4endl;
+      fPhysicsList->SetPhysicsTableRetrieved(fTableDirectory);
+    }
+  }
+  else if ( fConfigured && hasCouples && ! fTableDirectory.empty()
+            && currentState == G4State_Init
+            && requestedState == G4State_Idle ) {
+    // the tables are built, the workers share those of the master
+    if ( fRetrieving ) fPhysicsList->ResetPhysicsTableRetrieved();
+    else Store();
+    fTableDirectory = "";
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String PhysicsTableCache::GetKey() const
+{
+  std::ostringstream key;
+  key << fConfiguration << " " << G4VERSION_NUMBER
+      << " " << fPhysicsList->GetDefaultCutValue();
+
+  for ( auto region : *G4RegionStore::GetInstance() ) {
+    key << " " << region->GetName();
+    auto cuts = region->GetProductionCuts();
+    if ( ! cuts ) continue;
+    for ( G4int i = 0; i < NumberOfG4CutIndex; ++i ) {
+      key << " " << cuts->GetProductionCut(i);
+    }
+  }
+
+  for ( auto material : *G4Material::GetMaterialTable() ) {
+    key << " " << material->GetName() << " " << material->GetDensity();
+    for ( std::size_t i = 0; i < material->GetNumberOfElements(); ++i ) {
+      key << " " << material->GetElement(i)->GetName()
+          << " " << material->GetFractionVector()[i];
+    }
+  }
+
+  return ParameterHash(key.str());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhysicsTableCache::Store()
+{
+  // store under a private name and rename, so that concurrent jobs never
+  // retrieve a partial directory
+  std::ostringstream tmpDirectory;
+  tmpDirectory << fTableDirectory << "_" << getpid();
+  mkdir(fDirectory.c_str(), 0755);
+  mkdir(tmpDirectory.str().c_str(), 0755);
+
+  if ( ! fPhysicsList->StorePhysicsTable(tmpDirectory.str())
+       || std::rename(tmpDirectory.str().c_str(),
+                      fTableDirectory.c_str()) != 0 ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot store the physics tables in " << fTableDirectory;
+    G4Exception("PhysicsTableCache::Store()", "MyCode0010",
+                JustWarning, msg);
+    return;
+  }
+  G4cout << "Physics tables stored in " << fTableDirectory << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -1,4 +1,8 @@
 #include "PrimaryGeneratorAction.hh"
+#include "CalibrationScan.hh"
+#include "CosmicMuonGenerator.hh"
+#include "BarrelAcceptance.hh"
+#include "RunAction.hh"
 
 #include "G4LogicalVolumeStore.hh"
 #include "G4LogicalVolume.hh"
@@ -8,14 +12,30 @@
 #include "G4ParticleTable.hh"
 #include "G4ParticleDefinition.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4Event.hh"
+#include "G4GenericMessenger.hh"
 #include "Randomize.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-PrimaryGeneratorAction::PrimaryGeneratorAction()
+namespace
+{
+  // give up resampling after this many misses in a row
+  const G4int kMaxTrials = 1000000;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PrimaryGeneratorAction::PrimaryGeneratorAction(RunAction* runAction)
 : G4VUserPrimaryGeneratorAction(),
   fParticleGun(0), 
-  fEnvelopeBox(0)
+  fEnvelopeBox(0),
+  fRunAction(runAction),
+  fMessenger(nullptr),
+  fCosmicGenerator(nullptr),
+  fAcceptance(nullptr),
+  fCosmic(false),
+  fPreselect(true)
 {
   G4int n_particle = 1;
   fParticleGun  = new G4ParticleGun(n_particle);
@@ -29,17 +49,40 @@ PrimaryGeneratorAction::PrimaryGeneratorAction()
   fParticleGun->SetParticleMomentumDirection(G4ThreeVector(0.1,-10,0.1));
   fParticleGun->SetParticleEnergy(1024*MeV);
   fParticleGun->SetParticlePosition(G4ThreeVector(1.5 * cm, 1.5 * cm, 0 * cm));
+
+  fCosmicGenerator = new CosmicMuonGenerator;
+  fAcceptance = new BarrelAcceptance;
+
+  // Define /muon/gun command directory using generic messenger class
+  fMessenger = new G4GenericMessenger(this, "/muon/gun/", "Primary generator");
+  auto& modeCmd
+    = fMessenger->DeclareMethod("mode", &PrimaryGeneratorAction::SetMode,
+        "fixed: the particle gun as set, cosmic: sea-level cosmic muons.");
+  modeCmd.SetParameterName("mode", false);
+  modeCmd.SetCandidates("fixed cosmic");
+  fMessenger->DeclareProperty("preselect", fPreselect,
+    "Resample cosmic muons whose line misses the barrel.");
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 PrimaryGeneratorAction::~PrimaryGeneratorAction()
 {
+  delete fMessenger;
+  delete fCosmicGenerator;
+  delete fAcceptance;
   delete fParticleGun;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void PrimaryGeneratorAction::SetMode(G4String mode)
+{
+  fCosmic = ( mode == "cosmic" );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
 {
   //this function is called at the begining of ecah event
@@ -48,7 +91,45 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
   // In order to avoid dependence of PrimaryGeneratorAction
   // on DetectorConstruction class we get Envelope volume
   // from G4LogicalVolumeStore.
-  
+
+  // calibration scan: fire at the grid cell of this event
+  auto calibration = CalibrationScan::Instance();
+  if ( calibration->IsActive() ) {
+    G4ThreeVector position, direction;
+    calibration->GetPrimary(anEvent->GetEventID(), position, direction);
+    fParticleGun->SetParticleDefinition(calibration->GetParticle());
+    fParticleGun->SetParticleEnergy(calibration->GetEnergy());
+    fParticleGun->SetParticlePosition(position);
+    fParticleGun->SetParticleMomentumDirection(direction);
+  }
+  else if ( fCosmic ) {
+    G4ParticleDefinition* particle;
+    G4double energy;
+    G4ThreeVector position, direction;
+    G4int trials = 0;
+    G4bool accepted;
+    do {
+      fCosmicGenerator->Generate(particle, energy, position, direction);
+      ++trials;
+      accepted = ! fPreselect || fAcceptance->Accept(position, direction);
+    } while ( ! accepted && trials < kMaxTrials );
+    fRunAction->AddGeneratedMuons(trials,
+                                  trials / fCosmicGenerator->GetRate());
+    if ( ! accepted ) {
+      // the sampled muons still count in the live time, none is fired
+      G4Exception("PrimaryGeneratorAction::GeneratePrimaries()", "MyCode0006",
+        JustWarning,
+        "No cosmic muon crossing the barrel was sampled, the event is "
+        "aborted. Check the generation surface and the built geometry.");
+      anEvent->SetEventAborted();
+      return;
+    }
+    fParticleGun->SetParticleDefinition(particle);
+    fParticleGun->SetParticleEnergy(energy);
+    fParticleGun->SetParticlePosition(position);
+    fParticleGun->SetParticleMomentumDirection(direction);
+  }
+
   fParticleGun->GeneratePrimaryVertex(anEvent);
 }
 
@@ -0,0 +1,151 @@
+#include "Run.hh"
+#include "CalibrationScan.hh"
+#include "ChannelId.hh"
+
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Run::Run()
+: G4Run(),
+  fChannelHits(ChannelId::kNumChannels, 0.),
+  fChannelPe(ChannelId::kNumChannels, 0.),
+  fChannelPe2(ChannelId::kNumChannels, 0.),
+  fChannelAbove(ChannelId::kNumChannels, 0.),
+  fStripCrossed(ChannelId::kNumStrips, 0.),
+  fStripDetected(ChannelId::kNumStrips, 0.)
+{
+  auto calibration = CalibrationScan::Instance();
+  if ( calibration->IsActive() ) {
+    fCalibrationSums.resize(calibration->GetNCells());
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Run::~Run()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Run::Merge(const G4Run* run)
+{
+  const Run* localRun = static_cast<const Run*>(run);
+
+  const auto& localSums = localRun->fCalibrationSums;
+  if ( fCalibrationSums.size() < localSums.size() ) {
+    fCalibrationSums.resize(localSums.size());
+  }
+  for ( std::size_t cell = 0; cell < localSums.size(); ++cell ) {
+    CellSums& sums = fCalibrationSums[cell];
+    const CellSums& local = localSums[cell];
+    sums.events += local.events;
+    sums.visibleEdep += local.visibleEdep;
+    for ( G4int end = 0; end < 2; ++end ) {
+      sums.pe[end] += local.pe[end];
+      sums.pe2[end] += local.pe2[end];
+      sums.timeEntries[end] += local.timeEntries[end];
+      sums.time[end] += local.time[end];
+      sums.time2[end] += local.time2[end];
+    }
+  }
+
+  for ( G4int channel = 0; channel < ChannelId::kNumChannels; ++channel ) {
+    fChannelHits[channel] += localRun->fChannelHits[channel];
+    fChannelPe[channel] += localRun->fChannelPe[channel];
+    fChannelPe2[channel] += localRun->fChannelPe2[channel];
+    fChannelAbove[channel] += localRun->fChannelAbove[channel];
+  }
+  for ( G4int strip = 0; strip < ChannelId::kNumStrips; ++strip ) {
+    fStripCrossed[strip] += localRun->fStripCrossed[strip];
+    fStripDetected[strip] += localRun->fStripDetected[strip];
+  }
+
+  fStepProfile.Merge(localRun->fStepProfile);
+
+  G4Run::Merge(run);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Run::AddCalibrationEvent(G4int cell, const G4int pe[2],
+                              const G4double time[2], G4double visibleEdep)
+{
+  CellSums& sums = fCalibrationSums[cell];
+  sums.events += 1.;
+  sums.visibleEdep += visibleEdep / MeV;
+  for ( G4int end = 0; end < 2; ++end ) {
+    sums.pe[end] += pe[end];
+    sums.pe2[end] += G4double(pe[end]) * pe[end];
+    if ( pe[end] == 0 ) continue;
+    G4double t = time[end] / ns;
+    sums.timeEntries[end] += 1.;
+    sums.time[end] += t;
+    sums.time2[end] += t * t;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Run::AddChannelHit(G4int channel, G4int photoelectrons,
+                        G4bool aboveThreshold)
+{
+  fChannelHits[channel] += 1.;
+  fChannelPe[channel] += photoelectrons;
+  fChannelPe2[channel] += G4double(photoelectrons) * photoelectrons;
+  if ( aboveThreshold ) fChannelAbove[channel] += 1.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Run::AddStripCrossing(G4int strip, G4bool detected)
+{
+  fStripCrossed[strip] += 1.;
+  if ( detected ) fStripDetected[strip] += 1.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool Run::WriteStripResponse(const G4String& fileName) const
+{
+  std::ofstream file(fileName);
+  if ( ! file ) return false;
+
+  file << "half,sector,layer,orientation,strip,crossed,detected,efficiency";
+  for ( G4int end = 0; end < ChannelId::kEnds; ++end ) {
+    file << ",hits" << end << ",above" << end
+         << ",meanPe" << end << ",rmsPe" << end;
+  }
+  file << "\n";
+
+  // only the strips that saw a crossing or a hit
+  for ( G4int strip = 0; strip < ChannelId::kNumStrips; ++strip ) {
+    G4int channel = strip * ChannelId::kEnds;
+    if ( fStripCrossed[strip] == 0. && fChannelHits[channel] == 0.
+         && fChannelHits[channel + 1] == 0. ) continue;
+
+    std::uint32_t id = ChannelId::FromIndex(channel);
+    G4double crossed = fStripCrossed[strip];
+    file << ChannelId::GetHalf(id) << "," << ChannelId::GetSector(id) << ","
+         << ChannelId::GetLayer(id) << "," << ChannelId::GetOrientation(id)
+         << "," << ChannelId::GetStrip(id) << "," << crossed << ","
+         << fStripDetected[strip] << ","
+         << ( crossed > 0. ? fStripDetected[strip] / crossed : 0. );
+    for ( G4int end = 0; end < ChannelId::kEnds; ++end ) {
+      G4double hits = fChannelHits[channel + end];
+      G4double mean = hits > 0. ? fChannelPe[channel + end] / hits : 0.;
+      G4double variance
+        = hits > 0. ? fChannelPe2[channel + end] / hits - mean * mean : 0.;
+      file << "," << hits << "," << fChannelAbove[channel + end]
+           << "," << mean << "," << std::sqrt(std::max(variance, 0.));
+    }
+    file << "\n";
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -1,41 +1,191 @@
 #include "RunAction.hh"
 #include "PrimaryGeneratorAction.hh"
 #include "DetectorConstruction.hh"
+#include "Run.hh"
+#include "SiPMDigitizer.hh"
+#include "CalibrationScan.hh"
+#include "StartupProfiler.hh"
 
 #include "G4RunManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4Threading.hh"
 #include "G4Run.hh"
 #include "G4AccumulableManager.hh"
+#include "G4DigiManager.hh"
 #include "G4LogicalVolumeStore.hh"
 #include "G4LogicalVolume.hh"
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
 
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 RunAction::RunAction()
-: G4UserRunAction()
-{}
+: G4UserRunAction(),
+  fOpticalBoundarySteps(0.),
+  fOpticalTracks(0.),
+  fFiredChannels(0),
+  fPhotoelectrons(0.),
+  fPhotoelectrons2(0.),
+  fDigitizedEvents(0),
+  fCells(0.),
+  fCells2(0.),
+  fGeneratedMuons(0.),
+  fLiveTime(0.),
+  fMessenger(nullptr),
+  fOutputQueueDepth(4096),
+  fOutputCompression(EventFormat::HasCompression() ? 1 : 0),
+  fPeThreshold(1.5),
+  fCrossingEdep(0.5 * MeV)
+{
+  G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
+  accumulableManager->RegisterAccumulable(fOpticalBoundarySteps);
+  accumulableManager->RegisterAccumulable(fOpticalTracks);
+  accumulableManager->RegisterAccumulable(fFiredChannels);
+  accumulableManager->RegisterAccumulable(fPhotoelectrons);
+  accumulableManager->RegisterAccumulable(fPhotoelectrons2);
+  accumulableManager->RegisterAccumulable(fDigitizedEvents);
+  accumulableManager->RegisterAccumulable(fCells);
+  accumulableManager->RegisterAccumulable(fCells2);
+  accumulableManager->RegisterAccumulable(fGeneratedMuons);
+  accumulableManager->RegisterAccumulable(fLiveTime);
+
+  // Define /muon/output command directory using generic messenger class
+  fMessenger = new G4GenericMessenger(this, "/muon/output/", "Event output");
+  fMessenger->DeclareProperty("fileName", fOutputFileName,
+    "Base name of the event files, empty to disable the output.");
+  fMessenger->DeclareProperty("queueDepth", fOutputQueueDepth,
+    "Number of events buffered between an event loop and its writer thread.");
+  fMessenger->DeclareProperty("compression", fOutputCompression,
+    "zlib compression level of the event blocks (0-9), 0 to disable.");
+  fMessenger->DeclareProperty("stripResponseFile", fStripResponseFile,
+    "Base name of the per-strip efficiency and light yield file, "
+    "empty (default) to disable it.");
+  auto& thresholdCmd
+    = fMessenger->DeclareProperty("peThreshold", fPeThreshold,
+        "Photoelectrons for a SiPM to count as detecting.");
+  thresholdCmd.SetParameterName("threshold", false);
+  thresholdCmd.SetRange("threshold>=0.");
+  auto& crossingCmd
+    = fMessenger->DeclarePropertyWithUnit("crossingEdep", "MeV", fCrossingEdep,
+        "Strip energy deposit for a strip to count as crossed.");
+  crossingCmd.SetParameterName("edep", false);
+  crossingCmd.SetRange("edep>=0.");
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 RunAction::~RunAction()
-{}
+{
+  delete fMessenger;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void RunAction::BeginOfRunAction(const G4Run*)
+G4Run* RunAction::GenerateRun()
+{
+  return new Run;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::BeginOfRunAction(const G4Run* run)
 { 
+  // the first run closes the startup phases
+  if ( IsMaster() ) StartupProfiler::Instance()->Report();
+
   // inform the runManager to save random number seed
   G4RunManager::GetRunManager()->SetRandomNumberStore(false);
+
+  // reset accumulables to their initial values
+  G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
+  accumulableManager->Reset();
+
+  // one event file per thread processing events
+  G4bool processesEvents
+    = ! IsMaster() || ! G4Threading::IsMultithreadedApplication();
+
+  // the digitizer of this thread updates its channels of the built
+  // geometry, which /run/reinitializeGeometry may have changed
+  if ( processesEvents ) {
+    auto digitizer = static_cast<SiPMDigitizer*>(
+      G4DigiManager::GetDMpointer()->FindDigitizerModule("SiPMDigitizer"));
+    if ( digitizer ) digitizer->BeginOfRun();
+  }
+  if ( processesEvents && ! fOutputFileName.empty() ) {
+    std::ostringstream fileName;
+    fileName << fOutputFileName << "_run" << run->GetRunID()
+             << "_t" << std::max(G4Threading::G4GetThreadId(), 0) << ".mev";
+    if ( fOutputCompression > 0 && ! EventFormat::HasCompression() ) {
+      G4Exception("RunAction::BeginOfRunAction()", "MyCode0005", JustWarning,
+        "Built without zlib, the event blocks are not compressed.");
+    }
+    if ( ! fEventWriter.Open(fileName.str(), std::max(fOutputQueueDepth, 1),
+                             std::min(std::max(fOutputCompression, 0), 9)) ) {
+      G4ExceptionDescription msg;
+      msg << "Cannot open the event file " << fileName.str();
+      G4Exception("RunAction::BeginOfRunAction()",
+        "MyCode0004", JustWarning, msg);
+    }
+  }
+
+  fTimer.Start();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void RunAction::EndOfRunAction(const G4Run* run)
 {
+  fTimer.Stop();
+  if ( fEventWriter.IsOpen() ) {
+    fEventWriter.Close();
+    const auto& writer = fEventWriter.GetWriter();
+    G4cout << " Event file: " << writer.GetNEvents() << " events, "
+           << writer.GetNHits() << " hits, "
+           << writer.GetBytesWritten() << " bytes written ("
+           << writer.GetUncompressedBytes() << " uncompressed)" << G4endl
+           << " Output queue: max depth " << fEventWriter.GetMaxQueueDepth()
+           << " of " << fEventWriter.GetQueueCapacity() << ", "
+           << fEventWriter.GetNStalls() << " stalls, stall time "
+           << G4BestUnit(fEventWriter.GetStallTime() * s, "Time") << G4endl;
+  }
+
   G4int nofEvents = run->GetNumberOfEvent();
   if (nofEvents == 0) return;
 
+  // merge accumulables
+  G4AccumulableManager* accumulableManager = G4AccumulableManager::Instance();
+  accumulableManager->Merge();
+
+  // the master writes the calibration scan results
+  auto calibration = CalibrationScan::Instance();
+  if ( IsMaster() && calibration->IsActive() ) {
+    calibration->EndOfRun(static_cast<const Run*>(run));
+  }
+
+  // per-strip efficiency and light yield
+  if ( IsMaster() && ! fStripResponseFile.empty() ) {
+    std::ostringstream fileName;
+    fileName << fStripResponseFile << "_run" << run->GetRunID() << ".csv";
+    if ( static_cast<const Run*>(run)->WriteStripResponse(fileName.str()) ) {
+      G4cout << " Strip response written to " << fileName.str() << G4endl;
+    }
+    else {
+      G4ExceptionDescription msg;
+      msg << "Cannot write the strip response to " << fileName.str();
+      G4Exception("RunAction::EndOfRunAction()",
+        "MyCode0011", JustWarning, msg);
+    }
+  }
+
+  // ranked stepping hotspots of /muon/profile/steps/enable
+  const StepProfile& stepProfile
+    = static_cast<const Run*>(run)->GetStepProfile();
+  if ( IsMaster() && ! stepProfile.IsEmpty() ) stepProfile.Print();
+
   // Print information of the run 
   // it's not a necessary part, just show something in terminal
   // we use G4AnalysisManager to record data in a root file
@@ -53,6 +203,9 @@ void RunAction::EndOfRunAction(const G4Run* run)
     runCondition += G4BestUnit(particleEnergy,"Energy");
   }
         
+  G4double meanPe = fPhotoelectrons.GetValue() / nofEvents;
+  G4double varPe = fPhotoelectrons2.GetValue() / nofEvents - meanPe * meanPe;
+
   if (IsMaster()) {
     G4cout
      << G4endl
@@ -67,6 +220,38 @@ void RunAction::EndOfRunAction(const G4Run* run)
   G4cout
      << G4endl
      << " The run consists of " << nofEvents << " "<< runCondition
+     << G4endl
+     << " Wall time: " << fTimer.GetRealElapsed() << " s ("
+     << nofEvents / fTimer.GetRealElapsed() << " events/s)"
+     << G4endl
+     << " SiPM channels fired per event: "
+     << G4double(fFiredChannels.GetValue()) / nofEvents
+     << ", photoelectrons per event: " << meanPe
+     << " (rms " << std::sqrt(std::max(varPe, 0.)) << ")"
+     << G4endl;
+  if ( fDigitizedEvents.GetValue() > 0 ) {
+    G4double nofDigitized = fDigitizedEvents.GetValue();
+    G4double meanCells = fCells.GetValue() / nofDigitized;
+    G4double varCells
+      = fCells2.GetValue() / nofDigitized - meanCells * meanCells;
+    G4cout
+     << " SiPM fired cells per event: " << meanCells
+     << " (rms " << std::sqrt(std::max(varCells, 0.)) << ")"
+     << G4endl;
+  }
+  G4cout
+     << " Optical tracks: " << fOpticalTracks.GetValue() << " ("
+     << fOpticalTracks.GetValue() / fTimer.GetRealElapsed() << " tracks/s)"
+     << G4endl
+     << " Optical boundary steps: " << fOpticalBoundarySteps.GetValue();
+  if ( fGeneratedMuons.GetValue() > 0. ) {
+    G4cout
+     << G4endl
+     << " Cosmic muons: " << fGeneratedMuons.GetValue() << " sampled, "
+     << "acceptance " << nofEvents / fGeneratedMuons.GetValue()
+     << ", live time " << G4BestUnit(fLiveTime.GetValue() * s, "Time");
+  }
+  G4cout
      << G4endl
      << "------------------------------------------------------------"
      << G4endl
@@ -75,3 +260,20 @@ void RunAction::EndOfRunAction(const G4Run* run)
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void RunAction::AddSiPMHits(G4int channels, G4int photoelectrons)
+{
+  fFiredChannels += channels;
+  fPhotoelectrons += photoelectrons;
+  fPhotoelectrons2 += G4double(photoelectrons) * photoelectrons;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::AddSiPMCells(G4int cells)
+{
+  fDigitizedEvents += 1;
+  fCells += cells;
+  fCells2 += G4double(cells) * cells;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,42 @@
+#include "SiPMDigi.hh"
+#include "ChannelId.hh"
+
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreadLocal G4Allocator<SiPMDigi>* SiPMDigiAllocator;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SiPMDigi::SiPMDigi(G4int channel, G4int avalanches, G4double charge,
+                   G4double time)
+: G4VDigi(),
+  fChannel(channel),
+  fAvalanches(avalanches),
+  fCharge(charge),
+  fTime(time)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SiPMDigi::~SiPMDigi()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SiPMDigi::Print()
+{
+  auto id = ChannelId::FromIndex(fChannel);
+  G4cout << "  SiPM[half " << ChannelId::GetHalf(id)
+         << " sector " << ChannelId::GetSector(id)
+         << " layer " << ChannelId::GetLayer(id)
+         << " orientation " << ChannelId::GetOrientation(id)
+         << " strip " << ChannelId::GetStrip(id)
+         << " end " << ChannelId::GetEnd(id) << "] " << fAvalanches
+         << " cells, " << fCharge / (1.e-12 * coulomb) << " pC, first at "
+         << G4BestUnit(fTime,"Time") << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
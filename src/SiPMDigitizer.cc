@@ -0,0 +1,341 @@
+#include "SiPMDigitizer.hh"
+#include "SiPMDigi.hh"
+#include "ChannelId.hh"
+#include "VolumeRoles.hh"
+
+#include "G4DigiManager.hh"
+#include "G4TransportationManager.hh"
+#include "G4Navigator.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "G4GenericMessenger.hh"
+#include "G4Poisson.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SiPMDigitizer::SiPMDigitizer(G4String name)
+: G4VDigitizerModule(name),
+  fMessenger(nullptr),
+  fEnabled(false),
+  fHCID(-1),
+  // middle of the WLS fibre emission spectrum (2.00-2.87 eV)
+  fModelBand(SiPMHit::GetBand(2.43*eV)),
+  fDarkRate(500. * kilohertz),
+  fWindow(100. * ns),
+  fCrosstalk(0.05),
+  fAfterpulse(0.03),
+  fAfterpulseCharge(0.5),
+  fGain(1.7e6),
+  fGainSpread(0.1),
+  // above single dark counts, see the README for the noise rate
+  fThreshold(1.5),
+  fValidChannel(ChannelId::kNumChannels, 0),
+  fSlot(ChannelId::kNumChannels, -1)
+{
+  collectionName.push_back("SiPMDigiColl");
+
+  // detection efficiency of a blue sensitive SiPM, bands of 50 nm from 300 nm
+  const G4double pde[SiPMHit::kNBands]
+    = { 0.20, 0.33, 0.40, 0.39, 0.33, 0.25, 0.17, 0.10 };
+  std::copy(pde, pde + SiPMHit::kNBands, fPde);
+
+  DefineCommands();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SiPMDigitizer::~SiPMDigitizer()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SiPMDigitizer::Digitize()
+{
+  auto digiManager = G4DigiManager::GetDMpointer();
+  if ( fHCID < 0 ) {
+    fHCID = digiManager->GetHitsCollectionID("SiPMSD/SiPMColl");
+  }
+  auto digiCollection = new SiPMDigiCollection(moduleName, collectionName[0]);
+
+  // signal cells: binomial detection of the tracked photons of each band,
+  // once per bundle for bundled photons, and of the model photoelectrons,
+  // which are in the fibre emission band
+  auto hitsCollection = static_cast<const SiPMHitsCollection*>(
+    digiManager->GetHitsCollection(fHCID));
+  if ( hitsCollection ) {
+    for ( std::size_t i = 0; i < hitsCollection->entries(); ++i ) {
+      auto hit = (*hitsCollection)[i];
+      G4int cells = 0;
+      if ( hit->GetModelPhotoelectrons() > 0 ) {
+        cells += G4int(CLHEP::RandBinomial::shoot(
+          hit->GetModelPhotoelectrons(), fPde[fModelBand]));
+      }
+      for ( G4int band = 0; band < SiPMHit::kNBands; ++band ) {
+        G4long photons = std::lround(hit->GetBandPhotons(band));
+        if ( photons > 0 ) {
+          cells += G4int(CLHEP::RandBinomial::shoot(photons, fPde[band]));
+        }
+        G4long bundles = std::lround(hit->GetBandBundles(band));
+        if ( bundles > 0 ) {
+          cells += DetectBundles(bundles, hit->GetBundleFactor(), fPde[band]);
+        }
+      }
+      if ( cells > 0 ) {
+        fAvalanches[GetSlot(hit->GetChannel(), hit->GetTime())] += cells;
+      }
+    }
+  }
+
+  // dark counts: the total of all channels, spread over random channels;
+  // those falling on channels that are not built are dropped
+  G4long darkCounts
+    = G4Poisson(ChannelId::kNumChannels * fDarkRate * fWindow);
+  for ( G4long i = 0; i < darkCounts; ++i ) {
+    G4int channel = std::min(G4int(G4UniformRand() * ChannelId::kNumChannels),
+                             ChannelId::kNumChannels - 1);
+    G4double time = G4UniformRand() * fWindow;
+    if ( fValidChannel[channel] ) fAvalanches[GetSlot(channel, time)] += 1;
+  }
+
+  // random numbers of the fired channels
+  std::size_t nofFired = fChannel.size();
+  fAfterpulses.resize(nofFired);
+  fGauss.resize(nofFired);
+  fCharge.resize(nofFired);
+  G4double crosstalkMean = fCrosstalk / ( 1. - fCrosstalk );
+  for ( std::size_t i = 0; i < nofFired; ++i ) {
+    fAvalanches[i] += G4int(G4Poisson(fAvalanches[i] * crosstalkMean));
+    fAfterpulses[i]
+      = G4int(CLHEP::RandBinomial::shoot(fAvalanches[i], fAfterpulse));
+  }
+  if ( nofFired > 0 ) {
+    CLHEP::RandGauss::shootArray(G4int(nofFired), fGauss.data());
+  }
+
+  // charge, without branches over the batch; the parameters are copied
+  // to locals so that the stores cannot alias them
+  const G4int* avalanches = fAvalanches.data();
+  const G4int* afterpulses = fAfterpulses.data();
+  const G4double* gauss = fGauss.data();
+  G4double* charge = fCharge.data();
+  const G4double cellCharge = fGain * eplus;
+  const G4double afterpulseCharge = fAfterpulseCharge;
+  const G4double gainSpread = fGainSpread;
+  for ( std::size_t i = 0; i < nofFired; ++i ) {
+    G4double cells = avalanches[i] + afterpulseCharge * afterpulses[i];
+    charge[i]
+      = cellCharge * ( cells + gainSpread * std::sqrt(cells) * gauss[i] );
+  }
+
+  // threshold, then reset the touched slots
+  const G4double minCharge = fThreshold * cellCharge;
+  for ( std::size_t i = 0; i < nofFired; ++i ) {
+    if ( charge[i] >= minCharge ) {
+      digiCollection->insert(
+        new SiPMDigi(fChannel[i], fAvalanches[i], charge[i], fTime[i]));
+    }
+    fSlot[fChannel[i]] = -1;
+  }
+  fChannel.clear();
+  fTime.clear();
+  fAvalanches.clear();
+
+  StoreDigiCollection(digiCollection);
+
+  if ( verboseLevel > 1 ) {
+    G4cout << G4endl << "-------->Digi Collection: in this event there are "
+           << digiCollection->entries() << " SiPM channels above threshold: "
+           << G4endl;
+    for ( std::size_t i = 0; i < digiCollection->entries(); ++i ) {
+      (*digiCollection)[i]->Print();
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int SiPMDigitizer::DetectBundles(G4long bundles, G4int bundleFactor,
+                                   G4double pde) const
+{
+  // each bundle of N photons fires m = N pde cells on average. With
+  // m <= 1 one Bernoulli draw per bundle gives a binomial of the
+  // Poisson number of bundles, i.e. a Poisson of the unbundled mean:
+  // the same statistics as detecting every photon of unbundled running.
+  // Above that the draw between floor(m) and floor(m) + 1 keeps the
+  // excess variance as small as the bundles allow.
+  G4double mean = bundleFactor * pde;
+  G4double whole = std::floor(mean);
+  G4int cells = G4int(whole) * G4int(bundles);
+  if ( mean > whole ) {
+    cells += G4int(CLHEP::RandBinomial::shoot(bundles, mean - whole));
+  }
+  return cells;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int SiPMDigitizer::GetSlot(G4int channel, G4double time)
+{
+  G4int slot = fSlot[channel];
+  if ( slot < 0 ) {
+    slot = fSlot[channel] = G4int(fChannel.size());
+    fChannel.push_back(channel);
+    fTime.push_back(time);
+    fAvalanches.push_back(0);
+  }
+  else if ( time < fTime[slot] ) {
+    fTime[slot] = time;
+  }
+  return slot;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SiPMDigitizer::BeginOfRun()
+{
+  // the geometry may have been rebuilt since the last run; the stores
+  // were cleaned, so the volumes are searched again
+  G4VPhysicalVolume* world
+    = G4TransportationManager::GetTransportationManager()
+        ->GetNavigatorForTracking()->GetWorldVolume();
+  std::fill(fValidChannel.begin(), fValidChannel.end(), 0);
+  if ( world ) CollectChannels(world->GetLogicalVolume(), 0, 0);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SiPMDigitizer::CollectChannels(const G4LogicalVolume* volume,
+                                    G4int envelope, G4int layer)
+{
+  // the copy numbers along envelope / Fe / layer / Al / strip give
+  // the channels, see ChannelId
+  for ( std::size_t i = 0; i < volume->GetNoDaughters(); ++i ) {
+    G4VPhysicalVolume* daughter = volume->GetDaughter(i);
+    const G4LogicalVolume* logical = daughter->GetLogicalVolume();
+    G4int copyNo = daughter->GetCopyNo();
+    switch ( VolumeRoles::Get(logical) ) {
+      case VolumeRole::kEnvelope:
+        CollectChannels(logical, copyNo, layer);
+        break;
+      case VolumeRole::kLayer:
+        CollectChannels(logical, envelope, copyNo);
+        break;
+      case VolumeRole::kAbsorber:
+      case VolumeRole::kSupport:
+        CollectChannels(logical, envelope, layer);
+        break;
+      case VolumeRole::kStrip:
+        for ( G4int end = 0; end < ChannelId::kEnds; ++end ) {
+          auto id = ChannelId::Pack(envelope / ChannelId::kSectors,
+                                    envelope % ChannelId::kSectors, layer,
+                                    copyNo / ChannelId::kStrips,
+                                    copyNo % ChannelId::kStrips, end);
+          fValidChannel[ChannelId::ToIndex(id)] = 1;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SiPMDigitizer::SetPde(G4String value)
+{
+  G4double pde[SiPMHit::kNBands];
+  std::istringstream is(value);
+  G4int nofValues = 0;
+  G4double efficiency;
+  while ( nofValues < SiPMHit::kNBands && is >> efficiency ) {
+    pde[nofValues++] = efficiency;
+  }
+  if ( nofValues != SiPMHit::kNBands || is >> efficiency
+       || *std::min_element(pde, pde + nofValues) < 0.
+       || *std::max_element(pde, pde + nofValues) > 1. ) {
+    G4ExceptionDescription msg;
+    msg << "The PDE needs " << SiPMHit::kNBands
+        << " values in [0, 1], one per band of 50 nm from 300 nm." << G4endl
+        << "The PDE is unchanged.";
+    G4Exception("SiPMDigitizer::SetPde()",
+      "MyCode0012", JustWarning, msg);
+    return;
+  }
+  std::copy(pde, pde + SiPMHit::kNBands, fPde);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SiPMDigitizer::DefineCommands()
+{
+  // Define /muon/sipm command directory using generic messenger class
+  fMessenger = new G4GenericMessenger(this, "/muon/sipm/",
+                                      "SiPM digitization");
+
+  fMessenger->DeclareProperty("digitize", fEnabled,
+    "Digitize the SiPM hits; the event output then holds the digis.");
+
+  auto& pdeCmd
+    = fMessenger->DeclareMethod("pde", &SiPMDigitizer::SetPde,
+        "Photon detection efficiency of the 8 bands of 50 nm from 300 nm.");
+  pdeCmd.SetParameterName("efficiencies", false);
+
+  auto& darkRateCmd
+    = fMessenger->DeclarePropertyWithUnit("darkRate", "kHz", fDarkRate,
+        "Dark count rate of one channel.");
+  darkRateCmd.SetParameterName("rate", false);
+  darkRateCmd.SetRange("rate>=0.");
+
+  auto& windowCmd
+    = fMessenger->DeclarePropertyWithUnit("window", "ns", fWindow,
+        "Integration window of the dark counts.");
+  windowCmd.SetParameterName("window", false);
+  windowCmd.SetRange("window>=0.");
+
+  auto& crosstalkCmd
+    = fMessenger->DeclareProperty("crosstalk", fCrosstalk,
+        "Probability of a cell to fire a neighbour.");
+  crosstalkCmd.SetParameterName("probability", false);
+  crosstalkCmd.SetRange("probability>=0. && probability<1.");
+
+  auto& afterpulseCmd
+    = fMessenger->DeclareProperty("afterpulse", fAfterpulse,
+        "Afterpulse probability per cell.");
+  afterpulseCmd.SetParameterName("probability", false);
+  afterpulseCmd.SetRange("probability>=0. && probability<=1.");
+
+  auto& afterpulseChargeCmd
+    = fMessenger->DeclareProperty("afterpulseCharge", fAfterpulseCharge,
+        "Charge of an afterpulse, in cells.");
+  afterpulseChargeCmd.SetParameterName("fraction", false);
+  afterpulseChargeCmd.SetRange("fraction>=0.");
+
+  auto& gainCmd
+    = fMessenger->DeclareProperty("gain", fGain,
+        "Electrons per fired cell.");
+  gainCmd.SetParameterName("gain", false);
+  gainCmd.SetRange("gain>0.");
+
+  auto& gainSpreadCmd
+    = fMessenger->DeclareProperty("gainSpread", fGainSpread,
+        "Relative gain spread of a cell.");
+  gainSpreadCmd.SetParameterName("spread", false);
+  gainSpreadCmd.SetRange("spread>=0.");
+
+  auto& thresholdCmd
+    = fMessenger->DeclareProperty("threshold", fThreshold,
+        "Threshold on the charge, in cells.");
+  thresholdCmd.SetParameterName("threshold", false);
+  thresholdCmd.SetRange("threshold>=0.");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
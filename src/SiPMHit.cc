@@ -0,0 +1,70 @@
+#include "SiPMHit.hh"
+#include "ChannelId.hh"
+
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+
+#include <algorithm>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreadLocal G4Allocator<SiPMHit>* SiPMHitAllocator;
+
+namespace {
+  const G4double kFirstWavelength = 300.*nm;
+  const G4double kBandWidth = 50.*nm;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SiPMHit::SiPMHit(G4int channel, G4int npe, G4int modelPe, G4double time,
+                 const G4float* bandPhotons, const G4float* bandBundles,
+                 G4int bundleFactor)
+: G4VHit(),
+  fChannel(channel),
+  fPhotoelectrons(npe),
+  fModelPhotoelectrons(modelPe),
+  fTime(time),
+  fBundleFactor(bundleFactor)
+{
+  std::copy(bandPhotons, bandPhotons + kNBands, fBandPhotons.begin());
+  std::copy(bandBundles, bandBundles + kNBands, fBandBundles.begin());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SiPMHit::~SiPMHit()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SiPMHit::Print()
+{
+  auto id = ChannelId::FromIndex(fChannel);
+  G4cout << "  SiPM[half " << ChannelId::GetHalf(id)
+         << " sector " << ChannelId::GetSector(id)
+         << " layer " << ChannelId::GetLayer(id)
+         << " orientation " << ChannelId::GetOrientation(id)
+         << " strip " << ChannelId::GetStrip(id)
+         << " end " << ChannelId::GetEnd(id) << "] " << fPhotoelectrons
+         << " p.e., first photon at " << G4BestUnit(fTime,"Time") << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int SiPMHit::GetBand(G4double photonEnergy)
+{
+  G4int band
+    = G4int((h_Planck * c_light / photonEnergy - kFirstWavelength) / kBandWidth);
+  return std::min(std::max(band, 0), kNBands - 1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double SiPMHit::GetBandWavelength(G4int band)
+{
+  return kFirstWavelength + ( band + 0.5 ) * kBandWidth;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,132 @@
+#include "SiPMSD.hh"
+#include "ChannelId.hh"
+
+#include "G4HCofThisEvent.hh"
+#include "G4TouchableHistory.hh"
+#include "G4Track.hh"
+#include "G4Step.hh"
+#include "G4SDManager.hh"
+#include "G4OpticalPhoton.hh"
+
+#include <algorithm>
+#include <limits>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SiPMSD::SiPMSD(G4String name, G4int bundleFactor)
+: G4VSensitiveDetector(name),
+  fHitsCollection(nullptr),
+  fHCID(-1),
+  fOpticalPhoton(G4OpticalPhoton::Definition()),
+  fBundleFactor(bundleFactor),
+  fPhotoelectrons(ChannelId::kNumChannels, 0),
+  fPhotonWeights(ChannelId::kNumChannels, 0.),
+  fFirstTime(ChannelId::kNumChannels, std::numeric_limits<G4double>::max()),
+  fBandPhotons(ChannelId::kNumChannels * SiPMHit::kNBands, 0.f),
+  fBandBundles(ChannelId::kNumChannels * SiPMHit::kNBands, 0.f)
+{
+  collectionName.insert("SiPMColl");
+  fFiredChannels.reserve(ChannelId::kNumChannels);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SiPMSD::~SiPMSD()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SiPMSD::Initialize(G4HCofThisEvent* hce)
+{
+  fHitsCollection 
+    = new SiPMHitsCollection(SensitiveDetectorName, collectionName[0]);
+
+  if (fHCID<0) { 
+     fHCID = G4SDManager::GetSDMpointer()->GetCollectionID(fHitsCollection);
+  }
+  hce->AddHitsCollection(fHCID, fHitsCollection);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool SiPMSD::ProcessHits(G4Step* step, G4TouchableHistory*)
+{
+  G4Track* track = step->GetTrack();
+  if ( track->GetDefinition() != fOpticalPhoton ) return false;
+
+  auto preStepPoint = step->GetPreStepPoint();
+  G4int channel
+    = ChannelId::ToIndex(ChannelId::FromSiPMTouchable(preStepPoint->GetTouchable()));
+  AddPhotons(channel, SiPMHit::GetBand(track->GetTotalEnergy()),
+             track->GetWeight(), preStepPoint->GetGlobalTime());
+
+  // the photon is absorbed in the SiPM
+  track->SetTrackStatus(fStopAndKill);
+
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SiPMSD::EndOfEvent(G4HCofThisEvent*)
+{
+  // one hit per fired channel, then reset only the touched entries
+  for ( auto channel : fFiredChannels ) {
+    G4double weight = fPhotonWeights[channel];
+    G4int npe = fPhotoelectrons[channel] + G4int(weight + 0.5);
+    G4float* bands = &fBandPhotons[channel * SiPMHit::kNBands];
+    G4float* bundles = &fBandBundles[channel * SiPMHit::kNBands];
+    if ( npe > 0 ) {
+      fHitsCollection->insert(new SiPMHit(channel, npe,
+        fPhotoelectrons[channel], fFirstTime[channel], bands, bundles,
+        fBundleFactor));
+    }
+    fPhotoelectrons[channel] = 0;
+    fPhotonWeights[channel] = 0.;
+    fFirstTime[channel] = std::numeric_limits<G4double>::max();
+    std::fill(bands, bands + SiPMHit::kNBands, 0.f);
+    std::fill(bundles, bundles + SiPMHit::kNBands, 0.f);
+  }
+  fFiredChannels.clear();
+
+  if ( verboseLevel>1 ) {
+     auto nofHits = fHitsCollection->entries();
+     G4cout
+       << G4endl
+       << "-------->Hits Collection: in this event there are " << nofHits
+       << " fired SiPM channels: " << G4endl;
+     for ( std::size_t i=0; i<nofHits; ++i ) (*fHitsCollection)[i]->Print();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SiPMSD::AddPhotoelectrons(G4int channel, G4int npe, G4double time)
+{
+  if ( fFirstTime[channel] == std::numeric_limits<G4double>::max() ) {
+    fFiredChannels.push_back(channel);
+  }
+  fPhotoelectrons[channel] += npe;
+  if ( time < fFirstTime[channel] ) fFirstTime[channel] = time;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SiPMSD::AddPhotons(G4int channel, G4int band, G4double weight,
+                        G4double time)
+{
+  if ( fFirstTime[channel] == std::numeric_limits<G4double>::max() ) {
+    fFiredChannels.push_back(channel);
+  }
+  fPhotonWeights[channel] += weight;
+  // a bundle is one tracked photon standing for fBundleFactor photons
+  if ( fBundleFactor > 1 && weight > 1. ) {
+    fBandBundles[channel * SiPMHit::kNBands + band] += weight / fBundleFactor;
+  }
+  else {
+    fBandPhotons[channel * SiPMHit::kNBands + band] += weight;
+  }
+  if ( time < fFirstTime[channel] ) fFirstTime[channel] = time;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
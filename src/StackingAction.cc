@@ -0,0 +1,178 @@
+#include "StackingAction.hh"
+#include "EventAction.hh"
+#include "VolumeRoles.hh"
+#include "ChannelId.hh"
+#include "DetectorConstruction.hh"
+#include "SiPMSD.hh"
+
+#include "G4Track.hh"
+#include "G4OpticalPhoton.hh"
+#include "G4StackManager.hh"
+#include "G4GenericMessenger.hh"
+#include "G4RunManager.hh"
+#include "G4SDManager.hh"
+#include "G4Material.hh"
+#include "G4Box.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4MaterialPropertiesTable.hh"
+#include "G4VProcess.hh"
+#include "G4EmProcessSubType.hh"
+#include "G4NavigationHistory.hh"
+#include "G4SystemOfUnits.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StackingAction::StackingAction(EventAction* eventAction, G4int bundleFactor)
+: G4UserStackingAction(),
+  fEventAction(eventAction),
+  fBundleFactor(bundleFactor),
+  fMessenger(nullptr),
+  fOpticalPhoton(G4OpticalPhoton::Definition()),
+  fDeferOptical(true),
+  fStripThreshold(0.3 * MeV),
+  fOpticalStage(false),
+  fReclassifying(false),
+  fStripLightThreads(0),
+  fResponseMap(nullptr),
+  fSiPMSD(nullptr),
+  fScintillator(nullptr),
+  fPhotonsPerMeV(0.),
+  fWarnedUncalibrated(false)
+{
+  // Define /muon/stacking command directory using generic messenger class
+  fMessenger = new G4GenericMessenger(this, "/muon/stacking/",
+                                      "Optical photon stacking");
+  fMessenger->DeclareProperty("deferOptical", fDeferOptical,
+    "Track the optical photons after the charged particles, only in strips "
+    "above threshold.");
+  auto& thresholdCmd
+    = fMessenger->DeclarePropertyWithUnit("stripThreshold", "MeV",
+        fStripThreshold,
+        "Strip energy deposit above which its optical photons are tracked.");
+  thresholdCmd.SetParameterName("threshold", false);
+  thresholdCmd.SetRange("threshold>=0.");
+  auto& threadsCmd
+    = fMessenger->DeclareProperty("stripLightThreads", fStripLightThreads,
+        "Parametrise the strip photons with the calibrated light response "
+        "map on a shared pool of this many threads, 0 to track them.");
+  threadsCmd.SetParameterName("threads", false);
+  threadsCmd.SetRange("threads>=0");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StackingAction::~StackingAction()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ClassificationOfNewTrack
+StackingAction::ClassifyNewTrack(const G4Track* track)
+{
+  if ( ! fDeferOptical || track->GetDefinition() != fOpticalPhoton ) {
+    return fUrgent;
+  }
+  if ( ! fOpticalStage ) return fWaiting;
+  if ( fEventAction->IsCalibrating() ) return fUrgent;
+
+  // second stage: keep the photons of the strips that passed the threshold
+  const G4VTouchable* touchable = track->GetTouchable();
+  if ( ! touchable ) return fUrgent;
+  G4int depth = VolumeRoles::FindDepth(touchable, VolumeRole::kStrip);
+  if ( depth < 0 ) return fUrgent;
+
+  std::uint32_t stripId = ChannelId::FromStripTouchable(touchable, depth);
+  G4int strip = ChannelId::ToStripIndex(stripId);
+  if ( fEventAction->GetStripEdep(strip) < fStripThreshold ) return fKill;
+  if ( fStripLightThreads <= 0 || ! UseStripLightModel() ) return fUrgent;
+
+  // the light response map holds all the light of the calibration,
+  // Cerenkov and WLS included, per visible deposit: only the
+  // scintillation photons are converted, the others are dropped
+  auto creator = track->GetCreatorProcess();
+  if ( ! creator || creator->GetProcessSubType() != fScintillation ) {
+    return fKill;
+  }
+  // photons born after the strips were converted wait for the next stage
+  if ( ! fReclassifying ) return fWaiting;
+
+  // converted with the other photons of the strip in NewStage(); these
+  // are never tracked, so the bundle weight of the tracking action is
+  // applied here
+  G4double weight = track->GetWeight() * fBundleFactor;
+  // yield of the material the photon is born in, not looked up by name:
+  // a geometry read from the cache has its own material instances
+  const G4Material* material
+    = touchable->GetVolume()->GetLogicalVolume()->GetMaterial();
+  if ( material != fScintillator ) {
+    fScintillator = material;
+    fPhotonsPerMeV = material->GetMaterialPropertiesTable()
+      ->GetConstProperty("SCINTILLATIONYIELD") * MeV;
+  }
+  G4ThreeVector local = touchable->GetHistory()
+    ->GetTransform(touchable->GetHistoryDepth() - depth)
+    .TransformPoint(track->GetPosition());
+  auto solid = static_cast<const G4Box*>(touchable->GetSolid(depth));
+  fStripLight.AddPhoton(stripId, solid->GetYHalfLength(), local,
+                        track->GetGlobalTime(), weight);
+  return fKill;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StackingAction::NewStage()
+{
+  // the first new stage starts when the charged particles are done and
+  // the strip deposits are complete; later ones come with scintillation
+  // photons of parametrised strips born in the optical stage, which are
+  // converted then, before the event ends
+  fOpticalStage = true;
+  fReclassifying = true;
+  stackManager->ReClassify();
+  fReclassifying = false;
+
+  if ( fStripLight.IsEmpty() ) return;
+  fStripLight.Process(fResponseMap, fSiPMSD, fPhotonsPerMeV,
+                      fStripLightThreads);
+  fStripLight.Clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool StackingAction::UseStripLightModel()
+{
+  if ( ! fSiPMSD ) {
+    // the SD and the map exist once the geometry is built and are
+    // kept over /run/reinitializeGeometry
+    fSiPMSD = static_cast<SiPMSD*>(
+      G4SDManager::GetSDMpointer()->FindSensitiveDetector("SiPMSD"));
+    fResponseMap = static_cast<const DetectorConstruction*>(
+      G4RunManager::GetRunManager()->GetUserDetectorConstruction())
+        ->GetLightResponseMap();
+  }
+
+  // the analytic default map is no substitute for tracking
+  if ( fResponseMap->IsCalibrated() ) return true;
+  if ( ! fWarnedUncalibrated ) {
+    G4Exception("StackingAction::ClassifyNewTrack()", "MyCode0014",
+      JustWarning,
+      "stripLightThreads needs a calibrated light response map "
+      "(/muon/detector/lightResponseMap), the strip photons are tracked.");
+    fWarnedUncalibrated = true;
+  }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StackingAction::PrepareNewEvent()
+{
+  fOpticalStage = false;
+  fReclassifying = false;
+  fStripLight.Clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,173 @@
+#include "StartupProfiler.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4StateManager.hh"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StartupProfiler* StartupProfiler::Instance()
+{
+  // the state manager deletes its dependents, do not destroy it here
+  static StartupProfiler* instance = new StartupProfiler;
+  return instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StartupProfiler::StartupProfiler()
+: G4VStateDependent(),
+  fMessenger(nullptr),
+  fStart(std::chrono::steady_clock::now()),
+  fLast(TakeSample()),
+  fNInitPhases(0),
+  fReported(false)
+{
+  fMessenger = new G4GenericMessenger(this, "/muon/profile/",
+                                      "Startup profiling");
+  auto& fileCmd
+    = fMessenger->DeclareProperty("startupFile", fFileName,
+        "JSON file for the startup profile, empty for none.");
+  fileCmd.SetParameterName("fileName", false);
+  fileCmd.SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StartupProfiler::~StartupProfiler()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StartupProfiler::Sample StartupProfiler::TakeSample()
+{
+  Sample sample;
+  sample.wall = std::chrono::steady_clock::now();
+
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  sample.cpu = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+             + 1e-6 * ( usage.ru_utime.tv_usec + usage.ru_stime.tv_usec );
+#ifdef __APPLE__
+  sample.peakRss = usage.ru_maxrss / ( 1024. * 1024. );  // bytes
+#else
+  sample.peakRss = usage.ru_maxrss / 1024.;  // kilobytes
+#endif
+  return sample;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StartupProfiler::EndPhase(const G4String& name)
+{
+  if ( fReported ) return;
+
+  Sample sample = TakeSample();
+  std::chrono::duration<G4double> wall = sample.wall - fLast.wall;
+  fPhases.push_back({ name, wall.count(), sample.cpu - fLast.cpu,
+                      sample.peakRss });
+  fLast = sample;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool StartupProfiler::Notify(G4ApplicationState requestedState)
+{
+  if ( fReported ) return true;
+
+  // the kernel goes through Init for the physics construction
+  // (/run/initialize) and for the physics tables and the geometry
+  // optimisation (first run, or the MT initialization run that then
+  // starts the workers); time spent waiting for commands is skipped
+  auto currentState = G4StateManager::GetStateManager()->GetCurrentState();
+  if ( currentState == G4State_PreInit || currentState == G4State_Idle ) {
+    Restart();
+  }
+  else if ( currentState == G4State_Init && requestedState == G4State_Idle ) {
+    if ( fNInitPhases == 0 ) EndPhase("physics construction");
+    if ( fNInitPhases == 1 ) EndPhase("physics tables and voxelization");
+    ++fNInitPhases;
+  }
+  else if ( currentState == G4State_GeomClosed
+            && requestedState == G4State_Idle ) {
+    EndPhase("worker initialization");
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StartupProfiler::Report()
+{
+  if ( fReported ) return;
+  fReported = true;
+
+  G4double totalWall = 0.;
+  G4double totalCpu = 0.;
+  G4double peakRss = 0.;
+  for ( const auto& phase : fPhases ) {
+    totalWall += phase.wall;
+    totalCpu += phase.cpu;
+    peakRss = std::max(peakRss, phase.peakRss);
+  }
+
+  G4cout
+    << G4endl
+    << "--------------------- Startup profile ---------------------"
+    << G4endl
+    << std::left << std::setw(34) << " phase" << std::right
+    << std::setw(9) << "wall [s]" << std::setw(9) << "cpu [s]"
+    << std::setw(10) << "RSS [MB]" << G4endl;
+  auto print = [](const G4String& name, G4double wall, G4double cpu,
+                  G4double rss) {
+    G4cout << " " << std::left << std::setw(33) << name << std::right
+           << std::fixed << std::setprecision(3)
+           << std::setw(9) << wall << std::setw(9) << cpu
+           << std::setprecision(1) << std::setw(10) << rss
+           << std::defaultfloat << std::setprecision(6) << G4endl;
+  };
+  for ( const auto& phase : fPhases ) {
+    print(phase.name, phase.wall, phase.cpu, phase.peakRss);
+  }
+  print("total", totalWall, totalCpu, peakRss);
+  G4cout
+    << "-----------------------------------------------------------"
+    << G4endl;
+
+  if ( ! fFileName.empty() ) WriteJson();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StartupProfiler::WriteJson() const
+{
+  std::ofstream file(fFileName);
+  if ( ! file ) {
+    G4ExceptionDescription msg;
+    msg << "Cannot write the startup profile to " << fFileName;
+    G4Exception("StartupProfiler::WriteJson()", "MyCode0009",
+                JustWarning, msg);
+    return;
+  }
+
+  std::chrono::duration<G4double> sinceStart = fLast.wall - fStart;
+  file << "{\n  \"phases\": [";
+  for ( std::size_t i = 0; i < fPhases.size(); ++i ) {
+    const auto& phase = fPhases[i];
+    file << ( i ? ",\n" : "\n" )
+         << "    { \"name\": \"" << phase.name
+         << "\", \"wall_s\": " << phase.wall
+         << ", \"cpu_s\": " << phase.cpu
+         << ", \"peak_rss_mb\": " << phase.peakRss << " }";
+  }
+  file << "\n  ],\n  \"since_start_s\": " << sinceStart.count() << "\n}\n";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,147 @@
+#include "StepProfile.hh"
+
+#include "G4ParticleDefinition.hh"
+#include "G4OpticalPhoton.hh"
+#include "G4Gamma.hh"
+#include "G4Electron.hh"
+#include "G4Positron.hh"
+#include "G4MuonMinus.hh"
+#include "G4MuonPlus.hh"
+#include "G4Neutron.hh"
+
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+
+namespace
+{
+  const std::size_t kNumCells
+    = std::size_t(VolumeRole::kNumRoles) * std::size_t(ParticleKind::kNumKinds);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StepProfile::StepProfile()
+: fTracks(kNumCells, 0.),
+  fSteps(kNumCells, 0.),
+  fTime(kNumCells, 0.),
+  fBoundarySteps(0.),
+  fBoundaryTime(0.)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ParticleKind StepProfile::GetKind(const G4ParticleDefinition* particle)
+{
+  if ( particle == G4OpticalPhoton::Definition() ) {
+    return ParticleKind::kOpticalPhoton;
+  }
+  if ( particle == G4Gamma::Definition() ) return ParticleKind::kGamma;
+  if ( particle == G4Electron::Definition()
+       || particle == G4Positron::Definition() ) {
+    return ParticleKind::kElectron;
+  }
+  if ( particle == G4MuonMinus::Definition()
+       || particle == G4MuonPlus::Definition() ) {
+    return ParticleKind::kMuon;
+  }
+  if ( particle == G4Neutron::Definition() ) return ParticleKind::kNeutron;
+  if ( particle->GetParticleType() == "nucleus" ) return ParticleKind::kIon;
+  if ( particle->GetPDGCharge() != 0. ) return ParticleKind::kChargedHadron;
+  return ParticleKind::kOther;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const char* StepProfile::GetKindName(ParticleKind kind)
+{
+  switch ( kind )
+  {
+    case ParticleKind::kOpticalPhoton: return "opticalphoton";
+    case ParticleKind::kGamma:         return "gamma";
+    case ParticleKind::kElectron:      return "e-/e+";
+    case ParticleKind::kMuon:          return "mu-/mu+";
+    case ParticleKind::kChargedHadron: return "charged hadron";
+    case ParticleKind::kNeutron:       return "neutron";
+    case ParticleKind::kIon:           return "ion";
+    default:                           return "other";
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool StepProfile::IsEmpty() const
+{
+  return std::all_of(fSteps.begin(), fSteps.end(),
+                     [](G4double steps) { return steps == 0.; });
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StepProfile::Merge(const StepProfile& other)
+{
+  for ( std::size_t cell = 0; cell < kNumCells; ++cell ) {
+    fTracks[cell] += other.fTracks[cell];
+    fSteps[cell] += other.fSteps[cell];
+    fTime[cell] += other.fTime[cell];
+  }
+  fBoundarySteps += other.fBoundarySteps;
+  fBoundaryTime += other.fBoundaryTime;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StepProfile::Print(std::size_t maxRows) const
+{
+  std::vector<std::size_t> cells;
+  for ( std::size_t cell = 0; cell < kNumCells; ++cell ) {
+    if ( fSteps[cell] > 0. ) cells.push_back(cell);
+  }
+  std::sort(cells.begin(), cells.end(),
+            [this](std::size_t a, std::size_t b) {
+              return fTime[a] > fTime[b];
+            });
+  G4double totalTime = std::accumulate(fTime.begin(), fTime.end(), 0.);
+  G4double totalSteps = std::accumulate(fSteps.begin(), fSteps.end(), 0.);
+
+  G4cout
+    << G4endl
+    << "--------------------- Stepping hotspots ---------------------"
+    << G4endl
+    << std::left << std::setw(14) << " volume" << std::setw(16) << "particle"
+    << std::right << std::setw(11) << "tracks" << std::setw(13) << "steps"
+    << std::setw(10) << "time [s]" << std::setw(8) << "share"
+    << std::setw(10) << "ns/step" << G4endl;
+  for ( std::size_t i = 0; i < cells.size() && i < maxRows; ++i ) {
+    std::size_t cell = cells[i];
+    auto role = VolumeRole(cell / std::size_t(ParticleKind::kNumKinds));
+    auto kind = ParticleKind(cell % std::size_t(ParticleKind::kNumKinds));
+    G4cout
+      << " " << std::left << std::setw(13) << VolumeRoles::GetName(role)
+      << std::setw(16) << GetKindName(kind) << std::right
+      << std::setw(11) << std::setprecision(0) << std::fixed << fTracks[cell]
+      << std::setw(13) << fSteps[cell]
+      << std::setw(10) << std::setprecision(2) << fTime[cell]
+      << std::setw(7) << std::setprecision(1)
+      << ( totalTime > 0. ? 100. * fTime[cell] / totalTime : 0. ) << "%"
+      << std::setw(10) << std::setprecision(0)
+      << 1.e9 * fTime[cell] / fSteps[cell]
+      << std::defaultfloat << std::setprecision(6) << G4endl;
+  }
+  G4cout
+    << " " << cells.size() << " cells, "
+    << static_cast<long long>(totalSteps) << " steps, "
+    << totalTime << " s of sampled stepping time" << G4endl;
+  if ( fBoundarySteps > 0. ) {
+    G4cout
+      << " Optical boundary steps: "
+      << static_cast<long long>(fBoundarySteps) << ", "
+      << fBoundaryTime << " s, "
+      << 1.e9 * fBoundaryTime / fBoundarySteps << " ns/step" << G4endl;
+  }
+  G4cout
+    << "-------------------------------------------------------------"
+    << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
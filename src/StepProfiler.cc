@@ -0,0 +1,58 @@
+#include "StepProfiler.hh"
+#include "Run.hh"
+
+#include "G4GenericMessenger.hh"
+#include "G4RunManager.hh"
+#include "G4Track.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StepProfiler::StepProfiler()
+: fMessenger(nullptr),
+  fEnabled(false),
+  fSamplingPeriod(64),
+  fProfile(nullptr),
+  fKind(ParticleKind::kOther),
+  fStepCounter(0),
+  fSampling(false)
+{
+  fMessenger = new G4GenericMessenger(this, "/muon/profile/steps/",
+                                      "Stepping profile");
+  fMessenger->DeclareProperty("enable", fEnabled,
+    "Count tracks, steps and sampled time per volume role and particle.");
+  auto& periodCmd
+    = fMessenger->DeclareProperty("samplingPeriod", fSamplingPeriod,
+        "One step in samplingPeriod is timed.");
+  periodCmd.SetParameterName("period", false);
+  periodCmd.SetRange("period>=1");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StepProfiler::~StepProfiler()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StepProfiler::BeginTrack(const G4Track* track)
+{
+  // the profile of the current run on this thread
+  fProfile = &static_cast<Run*>(
+    G4RunManager::GetRunManager()->GetNonConstCurrentRun())->GetStepProfile();
+  fKind = StepProfile::GetKind(track->GetDefinition());
+
+  VolumeRole role = VolumeRole::kOther;
+  if ( track->GetVolume() ) {
+    role = VolumeRoles::Get(track->GetVolume()->GetLogicalVolume());
+  }
+  fProfile->AddTrack(StepProfile::GetCell(role, fKind));
+
+  // the time to the first step includes the track start, do not sample it
+  fSampling = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
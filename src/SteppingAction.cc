@@ -1,17 +1,34 @@
 #include "SteppingAction.hh"
 #include "EventAction.hh"
 #include "DetectorConstruction.hh"
+#include "VolumeRoles.hh"
+#include "ChannelId.hh"
+#include "SiPMSD.hh"
+#include "StripLightModel.hh"
+#include "StepProfiler.hh"
 
 #include "G4Step.hh"
 #include "G4Event.hh"
 #include "G4RunManager.hh"
 #include "G4LogicalVolume.hh"
+#include "G4OpticalPhoton.hh"
+#include "G4LossTableManager.hh"
+#include "G4EmSaturation.hh"
+#include "G4SDManager.hh"
+#include "G4Box.hh"
+#include "G4NavigationHistory.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-SteppingAction::SteppingAction(EventAction* eventAction)
+SteppingAction::SteppingAction(EventAction* eventAction,
+                               StepProfiler* stepProfiler, G4bool edepMode)
 : G4UserSteppingAction(),
-  fEventAction(eventAction)
+  fEventAction(eventAction),
+  fStepProfiler(stepProfiler),
+  fOpticalPhoton(G4OpticalPhoton::Definition()),
+  fEdepMode(edepMode),
+  fResponseMap(nullptr),
+  fSiPMSD(nullptr)
 {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -27,33 +44,104 @@ void SteppingAction::UserSteppingAction(const G4Step* step)
   G4LogicalVolume* volume 
     = step->GetPreStepPoint()->GetTouchableHandle()
       ->GetVolume()->GetLogicalVolume();
-      
-  // 10% loss of the scintillation internal surface reflection
-  if ( volume->GetName() == "Surface" )
+  VolumeRole role = VolumeRoles::Get(volume);
+  G4bool boundary
+    = ( step->GetPostStepPoint()->GetStepStatus() == fGeomBoundary );
+  if ( fStepProfiler->IsEnabled() ) fStepProfiler->Step(role, boundary);
+
+  // only optical photons are handled below
+  G4Track* currentTrack = step->GetTrack();
+  if ( currentTrack->GetDefinition() != fOpticalPhoton )
   {
-  auto currentTrack = step->GetTrack();
-  auto name = currentTrack->GetParticleDefinition()->GetParticleName();
-    if ( name == "opticalphoton" )
+    // energy deposit per strip, read by the stacking action
+    // (the strip light model deposits in the Strip envelope)
+    G4double edep = step->GetTotalEnergyDeposit();
+    if ( edep > 0.
+         && ( role == VolumeRole::kScintillator || role == VolumeRole::kSurface
+              || role == VolumeRole::kStrip ) )
     {
-      G4double random = G4UniformRand();
-      if(random < 0.1)
-      {
-        currentTrack->SetTrackStatus(fStopAndKill);
+      auto touchable = step->GetPreStepPoint()->GetTouchable();
+      G4int depth = VolumeRoles::FindDepth(touchable, VolumeRole::kStrip);
+      std::uint32_t stripId = ChannelId::FromStripTouchable(touchable, depth);
+      G4int strip = ChannelId::ToStripIndex(stripId);
+      fEventAction->AddStripEdep(strip, edep);
+      // only the BC420 scintillates, as in the full optical mode
+      if ( fEdepMode && role == VolumeRole::kScintillator ) {
+        DigitizeStep(step, touchable, depth, stripId);
+      }
+      // visible energy in the scanned strip for the calibration scan,
+      // not in the other strips the particle crosses
+      if ( role == VolumeRole::kScintillator
+           && strip == fEventAction->GetCalibrationStrip() ) {
+        fEventAction->AddVisibleEdep(G4LossTableManager::Instance()
+          ->EmSaturation()->VisibleEnergyDepositionAtAStep(step));
       }
     }
+    return;
   }
 
-  // make the photons that enter SiPM region disappear
-  if ( volume->GetName() == "SiPM" )
+  // count optical tracks and boundary crossings for the run benchmark
+  if ( currentTrack->GetCurrentStepNumber() == 1 )
+  {
+    fEventAction->AddOpticalTrack();
+  }
+  if ( boundary )
   {
-    auto currentTrack = step->GetTrack();
-    auto name = currentTrack->GetParticleDefinition()->GetParticleName();
-    if ( name == "opticalphoton" )
+    fEventAction->AddOpticalBoundaryStep();
+  }
+
+  // 10% loss of the scintillation internal surface reflection
+  if ( role == VolumeRole::kSurface )
+  {
+    G4double random = G4UniformRand();
+    if(random < 0.1)
     {
-      currentTrack->SetTrackStatus(fStopAndKill); 
-    } 
+      currentTrack->SetTrackStatus(fStopAndKill);
+    }
+  }
+  // make the photons that enter SiPM region disappear
+  else if ( role == VolumeRole::kSiPM )
+  {
+    currentTrack->SetTrackStatus(fStopAndKill); 
   } 
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+
+void SteppingAction::DigitizeStep(const G4Step* step,
+                                  const G4VTouchable* touchable,
+                                  G4int stripDepth, std::uint32_t stripId)
+{
+  // the SD and the map exist once the geometry is built and are
+  // kept over /run/reinitializeGeometry
+  if ( ! fSiPMSD ) {
+    fSiPMSD = static_cast<SiPMSD*>(
+      G4SDManager::GetSDMpointer()->FindSensitiveDetector("SiPMSD"));
+    fResponseMap = static_cast<const DetectorConstruction*>(
+      G4RunManager::GetRunManager()->GetUserDetectorConstruction())
+        ->GetLightResponseMap();
+  }
+
+  G4double visibleEdep = G4LossTableManager::Instance()->EmSaturation()
+                           ->VisibleEnergyDepositionAtAStep(step);
+  if ( visibleEdep <= 0. ) return;
+
+  // light emitted at the middle of the step, in the strip frame
+  auto preStepPoint = step->GetPreStepPoint();
+  auto postStepPoint = step->GetPostStepPoint();
+  G4ThreeVector middle
+    = 0.5 * ( preStepPoint->GetPosition() + postStepPoint->GetPosition() );
+  G4ThreeVector local = touchable->GetHistory()
+    ->GetTransform(touchable->GetHistoryDepth() - stripDepth)
+    .TransformPoint(middle);
+  G4double time
+    = 0.5 * ( preStepPoint->GetGlobalTime() + postStepPoint->GetGlobalTime() );
+
+  auto strip = static_cast<const G4Box*>(touchable->GetSolid(stripDepth));
+  StripLightModel::AddStripLight(fResponseMap, fSiPMSD, stripId,
+                                 strip->GetYHalfLength(), local,
+                                 visibleEdep, time);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,156 @@
+#include "StripLightModel.hh"
+#include "LightResponseMap.hh"
+#include "SiPMSD.hh"
+#include "ChannelId.hh"
+#include "VolumeRoles.hh"
+
+#include "G4FastTrack.hh"
+#include "G4FastStep.hh"
+#include "G4Box.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4Material.hh"
+#include "G4Track.hh"
+#include "G4VTouchable.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4GeometryTolerance.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace
+{
+  // the scintillator of a strip, from its volumes: a geometry read from
+  // the cache has its own material instances, not the DefineMaterials()
+  // ones, so the material is not looked up by name
+  const G4Material* FindScintillator(const G4LogicalVolume* volume)
+  {
+    for ( std::size_t i = 0; i < volume->GetNoDaughters(); ++i ) {
+      const G4LogicalVolume* daughter
+        = volume->GetDaughter(i)->GetLogicalVolume();
+      if ( VolumeRoles::Get(daughter) == VolumeRole::kScintillator ) {
+        return daughter->GetMaterial();
+      }
+      const G4Material* material = FindScintillator(daughter);
+      if ( material ) return material;
+    }
+    return nullptr;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StripLightModel::StripLightModel(G4String name, G4Region* region,
+                                 const LightResponseMap* responseMap,
+                                 SiPMSD* sipmSD)
+: G4VFastSimulationModel(name, region),
+  fResponseMap(responseMap),
+  fSiPMSD(sipmSD),
+  fRegion(region)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StripLightModel::~StripLightModel()
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool StripLightModel::IsApplicable(const G4ParticleDefinition& particle)
+{
+  return particle.GetPDGCharge() != 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool StripLightModel::ModelTrigger(const G4FastTrack& fastTrack)
+{
+  // only particles that leave the strip again
+  const G4Material* scintillator
+    = FindScintillator(fastTrack.GetEnvelopeLogicalVolume());
+  if ( ! scintillator ) return false;
+  G4double pathLength;
+  G4double energyLoss = GetEnergyLoss(fastTrack, scintillator, pathLength);
+  G4double tolerance = G4GeometryTolerance::GetInstance()->GetSurfaceTolerance();
+  if ( pathLength <= tolerance ) return false;
+  return energyLoss < fastTrack.GetPrimaryTrack()->GetKineticEnergy();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StripLightModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep)
+{
+  const G4Track* track = fastTrack.GetPrimaryTrack();
+  G4ThreeVector position = fastTrack.GetPrimaryTrackLocalPosition();
+  G4ThreeVector direction = fastTrack.GetPrimaryTrackLocalDirection();
+  const G4Material* scintillator
+    = FindScintillator(fastTrack.GetEnvelopeLogicalVolume());
+
+  G4double pathLength;
+  G4double energyLoss = GetEnergyLoss(fastTrack, scintillator, pathLength);
+  G4double time = track->GetGlobalTime() + pathLength / track->GetVelocity();
+
+  // move the particle to the strip exit
+  fastStep.ProposePrimaryTrackFinalPosition(position + pathLength * direction);
+  fastStep.ProposePrimaryTrackFinalTime(time);
+  fastStep.ProposePrimaryTrackFinalKineticEnergy(
+    track->GetKineticEnergy() - energyLoss);
+  fastStep.ProposePrimaryTrackPathLength(pathLength);
+  fastStep.ProposeTotalEnergyDeposited(energyLoss);
+
+  // Birks quenching with the mean stopping power along the path
+  G4double birksConstant
+    = scintillator->GetIonisation()->GetBirksConstant();
+  G4double visibleEdep
+    = energyLoss / ( 1. + birksConstant * energyLoss / pathLength );
+
+  // strip channel from the touchable, the strip being the envelope
+  const G4VTouchable* touchable = track->GetTouchable();
+  G4int depth = VolumeRoles::FindDepth(touchable, VolumeRole::kStrip);
+  std::uint32_t stripId = ChannelId::FromStripTouchable(touchable, depth);
+
+  // light is emitted around the middle of the path
+  G4ThreeVector middle = position + 0.5 * pathLength * direction;
+  G4double crossingTime = track->GetGlobalTime()
+                        + 0.5 * pathLength / track->GetVelocity();
+  auto strip = static_cast<const G4Box*>(fastTrack.GetEnvelopeSolid());
+  AddStripLight(fResponseMap, fSiPMSD, stripId, strip->GetYHalfLength(),
+                middle, visibleEdep, crossingTime);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StripLightModel::AddStripLight(const LightResponseMap* responseMap,
+                                    SiPMSD* sipmSD, std::uint32_t stripId,
+                                    G4double halfLength,
+                                    const G4ThreeVector& localPosition,
+                                    G4double visibleEdep, G4double time)
+{
+  for ( G4int end = 0; end < ChannelId::kEnds; ++end ) {
+    G4double distance = end == 0 ? halfLength + localPosition.y()
+                                 : halfLength - localPosition.y();
+    const auto& record = responseMap->Find(end, distance, localPosition.x());
+    G4int npe = responseMap->SamplePhotoelectrons(record, visibleEdep);
+    if ( npe == 0 ) continue;
+    sipmSD->AddPhotoelectrons(ChannelId::ToIndex(stripId | end), npe,
+      time + responseMap->SampleArrivalTime(record));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double StripLightModel::GetEnergyLoss(const G4FastTrack& fastTrack,
+                                        const G4Material* scintillator,
+                                        G4double& pathLength)
+{
+  pathLength = fastTrack.GetEnvelopeSolid()->DistanceToOut(
+    fastTrack.GetPrimaryTrackLocalPosition(),
+    fastTrack.GetPrimaryTrackLocalDirection());
+
+  const G4Track* track = fastTrack.GetPrimaryTrack();
+  G4double dedx = fEmCalculator.GetDEDX(track->GetKineticEnergy(),
+                                        track->GetParticleDefinition(),
+                                        scintillator, fRegion);
+  return dedx * pathLength;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
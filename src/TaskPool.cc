@@ -0,0 +1,123 @@
+#include "TaskPool.hh"
+
+#include <algorithm>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TaskPool* TaskPool::Instance()
+{
+  static TaskPool instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TaskPool::TaskPool()
+: fNThreads(0),
+  fStop(false)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TaskPool::~TaskPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fStop = true;
+  }
+  fWakeUp.notify_all();
+  for ( auto& thread : fThreads ) thread.join();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TaskPool::Reserve(G4int nThreads)
+{
+  G4int nCores = G4int(std::thread::hardware_concurrency());
+  if ( nCores > 0 ) nThreads = std::min(nThreads, nCores);
+
+  std::lock_guard<std::mutex> lock(fMutex);
+  while ( G4int(fThreads.size()) < nThreads ) {
+    fThreads.emplace_back(&TaskPool::Work, this);
+  }
+  fNThreads = G4int(fThreads.size());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TaskPool::Run(std::size_t nTasks,
+                   const std::function<void(std::size_t)>& task)
+{
+  if ( nTasks == 0 ) return;
+  if ( nTasks == 1 || fNThreads == 0 ) {
+    for ( std::size_t i = 0; i < nTasks; ++i ) task(i);
+    return;
+  }
+
+  Batch batch;
+  batch.task = &task;
+  batch.nTasks = nTasks;
+  batch.next = 0;
+  batch.done = 0;
+  batch.helpers = 0;
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fBatches.push_back(&batch);
+  }
+  fWakeUp.notify_all();
+
+  std::size_t done = RunTasks(batch);
+
+  // the batch lives on this stack: wait until no helper uses it
+  std::unique_lock<std::mutex> lock(fMutex);
+  batch.done += done;
+  Remove(&batch);
+  fFinished.wait(lock, [&batch]() {
+    return batch.done == batch.nTasks && batch.helpers == 0;
+  });
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::size_t TaskPool::RunTasks(Batch& batch)
+{
+  std::size_t done = 0;
+  for ( std::size_t i = batch.next++; i < batch.nTasks; i = batch.next++ ) {
+    (*batch.task)(i);
+    ++done;
+  }
+  return done;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TaskPool::Remove(Batch* batch)
+{
+  auto position = std::find(fBatches.begin(), fBatches.end(), batch);
+  if ( position != fBatches.end() ) fBatches.erase(position);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TaskPool::Work()
+{
+  std::unique_lock<std::mutex> lock(fMutex);
+  while ( true ) {
+    fWakeUp.wait(lock, [this]() { return fStop || ! fBatches.empty(); });
+    if ( fStop ) return;
+
+    Batch* batch = fBatches.front();
+    ++batch->helpers;
+    lock.unlock();
+    std::size_t done = RunTasks(*batch);
+    lock.lock();
+
+    // every task is claimed: no other helper needs to pick the batch
+    Remove(batch);
+    batch->done += done;
+    --batch->helpers;
+    fFinished.notify_all();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
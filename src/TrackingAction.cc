@@ -0,0 +1,40 @@
+#include "TrackingAction.hh"
+#include "StepProfiler.hh"
+
+#include "G4Track.hh"
+#include "G4VProcess.hh"
+#include "G4OpticalPhoton.hh"
+#include "G4EmProcessSubType.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TrackingAction::TrackingAction(G4int bundleFactor,
+                               StepProfiler* stepProfiler)
+: G4UserTrackingAction(),
+  fBundleFactor(bundleFactor),
+  fStepProfiler(stepProfiler),
+  fOpticalPhoton(G4OpticalPhoton::Definition())
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TrackingAction::~TrackingAction()
+{
+  delete fStepProfiler;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TrackingAction::PreUserTrackingAction(const G4Track* track)
+{
+  if ( fStepProfiler->IsEnabled() ) fStepProfiler->BeginTrack(track);
+
+  if ( fBundleFactor <= 1 || track->GetDefinition() != fOpticalPhoton ) return;
+
+  auto creator = track->GetCreatorProcess();
+  if ( creator && creator->GetProcessSubType() == fScintillation ) {
+    const_cast<G4Track*>(track)->SetWeight(track->GetWeight() * fBundleFactor);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,58 @@
+#include "VolumeRoles.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<VolumeRole> VolumeRoles::fRoles;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void VolumeRoles::Clear()
+{
+  fRoles.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void VolumeRoles::Set(const G4LogicalVolume* volume, VolumeRole role)
+{
+  std::size_t id = volume->GetInstanceID();
+  if ( id >= fRoles.size() ) fRoles.resize(id + 1, VolumeRole::kOther);
+  fRoles[id] = role;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int VolumeRoles::FindDepth(const G4VTouchable* touchable, VolumeRole role)
+{
+  G4int historyDepth = touchable->GetHistoryDepth();
+  for ( G4int depth = 0; depth <= historyDepth; ++depth ) {
+    if ( Get(touchable->GetVolume(depth)->GetLogicalVolume()) == role ) {
+      return depth;
+    }
+  }
+  return -1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const char* VolumeRoles::GetName(VolumeRole role)
+{
+  switch ( role )
+  {
+    case VolumeRole::kWorld:        return "World";
+    case VolumeRole::kEnvelope:     return "Envelope";
+    case VolumeRole::kAbsorber:     return "Fe";
+    case VolumeRole::kLayer:        return "Layer";
+    case VolumeRole::kSupport:      return "Al";
+    case VolumeRole::kStrip:        return "Strip";
+    case VolumeRole::kSurface:      return "Surface";
+    case VolumeRole::kScintillator: return "BC420";
+    case VolumeRole::kSlot:         return "Cut";
+    case VolumeRole::kCladding:     return "Cladding";
+    case VolumeRole::kFiberCore:    return "Core";
+    case VolumeRole::kSiPM:         return "SiPM";
+    default:                        return "Other";
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......